@@ -0,0 +1,187 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <stdex/aggregate_ring.h>
+
+TEST(aggregate_ring, default_contructor)
+{
+    auto r = stdex::aggregate_ring<int, 10>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+    EXPECT_EQ(0, r.sum());
+    EXPECT_DOUBLE_EQ(0.0, r.mean());
+    EXPECT_DOUBLE_EQ(0.0, r.variance());
+}
+
+TEST(aggregate_ring, init_args)
+{
+    auto r = stdex::aggregate_ring<int, 4>{2, 4, 4, 4, 5, 5, 7, 9};
+    EXPECT_EQ(4u, r.size());
+    EXPECT_EQ(26, r.sum());
+    EXPECT_DOUBLE_EQ(6.5, r.mean());
+    EXPECT_DOUBLE_EQ(2.75, r.variance());
+    EXPECT_EQ(5, r.min());
+    EXPECT_EQ(9, r.max());
+}
+
+TEST(aggregate_ring, matches_brute_force)
+{
+    auto rng  = std::mt19937(42);
+    auto dist = std::uniform_int_distribution<int>(-1000, 1000);
+
+    auto r   = stdex::aggregate_ring<int, 37, stdex::inline_storage>();
+    auto ref = std::deque<int>();
+    for (auto i = 0; i < 2000; i++)
+    {
+        auto v = dist(rng);
+        r.push_back(v);
+        ref.push_back(v);
+        if (ref.size() > 37u)
+        {
+            ref.pop_front();
+        }
+
+        auto sum  = std::accumulate(begin(ref), end(ref), 0);
+        auto mean = static_cast<double>(sum) / ref.size();
+        auto var  = 0.0;
+        for (auto x : ref)
+        {
+            var += (x - mean) * (x - mean);
+        }
+        var /= ref.size();
+
+        ASSERT_EQ(sum, r.sum());
+        ASSERT_NEAR(mean, r.mean(), 1e-6);
+        ASSERT_NEAR(var, r.variance(), 1e-3);
+        ASSERT_EQ(*std::min_element(begin(ref), end(ref)), r.min());
+        ASSERT_EQ(*std::max_element(begin(ref), end(ref)), r.max());
+    }
+}
+
+TEST(aggregate_ring, pop_front)
+{
+    auto r = stdex::aggregate_ring<int, 10>{1, 9, 3, 7};
+    r.pop_front();
+    EXPECT_EQ(19, r.sum());
+    EXPECT_EQ(3, r.min());
+    EXPECT_EQ(9, r.max());
+
+    r.pop_front();
+    EXPECT_EQ(10, r.sum());
+    EXPECT_EQ(3, r.min());
+    EXPECT_EQ(7, r.max());
+}
+
+struct gcd_op
+{
+    unsigned operator () (unsigned a, unsigned b) const
+    {
+        return std::gcd(a, b);
+    }
+};
+
+TEST(aggregate_ring, evicting_large_sample_keeps_precision)
+{
+    auto r = stdex::aggregate_ring<double, 5>{1e17, 1.0, 1.0, 1.0, 1.0};
+    r.pop_front();
+    EXPECT_DOUBLE_EQ(4.0, r.sum());
+    EXPECT_DOUBLE_EQ(1.0, r.mean());
+    EXPECT_DOUBLE_EQ(0.0, r.variance());
+}
+
+TEST(aggregate_ring, variance_does_not_drift)
+{
+    auto r = stdex::aggregate_ring<double, 16>();
+    for (auto i = 0; i < 1000000; i++)
+    {
+        r.push_back(i % 2 == 0 ? 1e8 + 0.1 : 1e8 - 0.1);
+    }
+    for (auto i = 0; i < 16; i++)
+    {
+        r.push_back(1e8);
+    }
+    EXPECT_DOUBLE_EQ(1e8, r.mean());
+    EXPECT_LE(0.0, r.variance());
+    EXPECT_NEAR(0.0, r.variance(), 1e-6);
+}
+
+TEST(aggregate_ring, large_window)
+{
+    // the window is kept on the heap, so a large ring fits on the stack
+    auto r = stdex::aggregate_ring<int, 1 << 22>();
+    for (auto i = 0; i < 1000; i++)
+    {
+        r.push_back(i);
+    }
+    auto moved = std::move(r);
+    EXPECT_EQ(1000u, moved.size());
+    EXPECT_EQ(0, moved.min());
+    EXPECT_EQ(999, moved.max());
+    EXPECT_DOUBLE_EQ(499.5, moved.mean());
+}
+
+TEST(fold_ring, gcd)
+{
+    auto r = stdex::fold_ring<unsigned, 3, gcd_op>();
+    r.push_back(12);
+    EXPECT_EQ(12u, r.fold());
+    r.push_back(18);
+    EXPECT_EQ(6u, r.fold());
+    r.push_back(30);
+    EXPECT_EQ(6u, r.fold());
+    r.push_back(45);
+    EXPECT_EQ(3u, r.fold());
+    r.push_back(60);
+    EXPECT_EQ(15u, r.fold());
+}
+
+TEST(fold_ring, bit_or_matches_brute_force)
+{
+    auto rng  = std::mt19937(7);
+    auto dist = std::uniform_int_distribution<unsigned>(0, 31);
+
+    auto r   = stdex::fold_ring<unsigned, 16, std::bit_or<unsigned>>();
+    auto ref = std::deque<unsigned>();
+    for (auto i = 0; i < 1000; i++)
+    {
+        auto v = 1u << dist(rng);
+        r.push_back(v);
+        ref.push_back(v);
+        if (ref.size() > 16u)
+        {
+            ref.pop_front();
+        }
+        ASSERT_EQ(std::accumulate(begin(ref), end(ref), 0u, std::bit_or<unsigned>()), r.fold());
+    }
+}
+
+TEST(fold_ring, keeps_order)
+{
+    // concatenation is associative but not commutative
+    auto r = stdex::fold_ring<std::string, 3, std::plus<std::string>>();
+    for (auto s : {"a", "b", "c", "d", "e"})
+    {
+        r.push_back(s);
+    }
+    EXPECT_EQ("cde", r.fold());
+
+    r.pop_front();
+    EXPECT_EQ("de", r.fold());
+
+    r.push_back("f");
+    EXPECT_EQ("def", r.fold());
+}
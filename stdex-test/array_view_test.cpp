@@ -345,3 +345,25 @@ TEST(array_view, for_each)
         i++;
     }
 }
+
+TEST(array_span, write)
+{
+    auto values = std::vector<int>{0, 1, 2, 3, 4};
+    auto as = stdex::array_span<int>(values);
+    for (auto& v : as)
+    {
+        v *= 2;
+    }
+    as[0] = 99;
+
+    auto ref = std::vector<int>{99, 2, 4, 6, 8};
+    EXPECT_EQ(ref, values);
+}
+
+TEST(array_span, to_array_view)
+{
+    auto values = std::array<int, 3>{1, 2, 3};
+    auto av = stdex::array_view<int>(stdex::array_span<int>(values));
+    EXPECT_EQ(3u, av.size());
+    EXPECT_EQ(values.data(), av.data());
+}
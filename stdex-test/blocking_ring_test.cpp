@@ -0,0 +1,187 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <stdex/blocking_ring.h>
+
+using namespace std::chrono_literals;
+
+TEST(blocking_ring, default_contructor)
+{
+    auto r = stdex::blocking_ring<int, 10>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_FALSE(r.closed());
+    EXPECT_EQ(10u, r.capacity());
+}
+
+TEST(blocking_ring, try_push_pop)
+{
+    auto r = stdex::blocking_ring<int, 2>();
+    EXPECT_TRUE(r.try_push(1));
+    EXPECT_TRUE(r.try_push(2));
+    EXPECT_FALSE(r.try_push(3));
+
+    auto v = 0;
+    EXPECT_TRUE(r.try_pop(v));
+    EXPECT_EQ(1, v);
+}
+
+TEST(blocking_ring, pop_wait_for_timeout)
+{
+    auto r = stdex::blocking_ring<int, 2>();
+    auto v = 0;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_FALSE(r.pop_wait_for(v, 20ms));
+    EXPECT_LE(20ms, std::chrono::steady_clock::now() - start);
+}
+
+TEST(blocking_ring, push_wait_for_timeout)
+{
+    auto r = stdex::blocking_ring<int, 2>();
+    EXPECT_TRUE(r.push_wait(1));
+    EXPECT_TRUE(r.push_wait(2));
+    EXPECT_FALSE(r.push_wait_for(3, 10ms));
+}
+
+TEST(blocking_ring, pop_wait_wakes_up)
+{
+    auto r = stdex::blocking_ring<int, 2>();
+    auto consumer = std::thread([&] () {
+        auto v = 0;
+        EXPECT_TRUE(r.pop_wait(v));
+        EXPECT_EQ(42, v);
+    });
+    std::this_thread::sleep_for(10ms);
+    EXPECT_TRUE(r.push_wait(42));
+    consumer.join();
+}
+
+TEST(blocking_ring, close_wakes_up)
+{
+    auto r = stdex::blocking_ring<int, 2>();
+    auto consumer = std::thread([&] () {
+        auto v = 0;
+        EXPECT_FALSE(r.pop_wait(v));
+    });
+    std::this_thread::sleep_for(10ms);
+    r.close();
+    consumer.join();
+
+    EXPECT_FALSE(r.try_push(1));
+    EXPECT_FALSE(r.push_wait(1));
+}
+
+TEST(blocking_ring, drain_after_close)
+{
+    auto r = stdex::blocking_ring<int, 4>();
+    r.push_wait(1);
+    r.push_wait(2);
+    r.close();
+
+    auto v = 0;
+    EXPECT_TRUE(r.pop_wait(v));
+    EXPECT_EQ(1, v);
+    EXPECT_TRUE(r.pop_wait(v));
+    EXPECT_EQ(2, v);
+    EXPECT_FALSE(r.pop_wait(v));
+}
+
+TEST(blocking_ring, no_push_after_close)
+{
+    for (auto round = 0; round < 200; round++)
+    {
+        auto r     = stdex::blocking_ring<int, 64>();
+        auto start = std::atomic<bool>(false);
+        auto producers = std::vector<std::thread>();
+        for (auto i = 0; i < 2; i++)
+        {
+            producers.emplace_back([&] () {
+                while (!start) {}
+                auto v = 0;
+                while (!r.closed())
+                {
+                    if (!r.try_push(v))
+                    {
+                        // make room so that pushes keep racing close
+                        r.try_pop(v);
+                    }
+                    v++;
+                }
+            });
+        }
+
+        start = true;
+        std::this_thread::yield();
+        r.close();
+        auto v = 0;
+        while (r.try_pop(v)) {}
+
+        for (auto& p : producers)
+        {
+            p.join();
+        }
+        ASSERT_TRUE(r.empty());
+    }
+}
+
+TEST(blocking_ring, move_only)
+{
+    auto r = stdex::blocking_ring<std::unique_ptr<int>, 4>();
+    EXPECT_TRUE(r.push_wait(std::make_unique<int>(5)));
+
+    auto v = std::unique_ptr<int>();
+    EXPECT_TRUE(r.pop_wait(v));
+    EXPECT_EQ(5, *v);
+}
+
+TEST(blocking_ring, pipeline)
+{
+    constexpr auto count = 100000u;
+    auto r = stdex::blocking_ring<unsigned, 64>();
+    auto sum = std::atomic<unsigned long long>{0};
+
+    auto consumers = std::vector<std::thread>();
+    for (auto i = 0; i < 2; i++)
+    {
+        consumers.emplace_back([&] () {
+            auto v = 0u;
+            while (r.pop_wait(v))
+            {
+                sum += v;
+            }
+        });
+    }
+
+    auto producers = std::vector<std::thread>();
+    for (auto i = 0; i < 2; i++)
+    {
+        producers.emplace_back([&] () {
+            for (auto j = 0u; j < count; j++)
+            {
+                EXPECT_TRUE(r.push_wait(j));
+            }
+        });
+    }
+    for (auto& p : producers)
+    {
+        p.join();
+    }
+    r.close();
+    for (auto& c : consumers)
+    {
+        c.join();
+    }
+
+    EXPECT_EQ(2ull * count * (count - 1) / 2, sum.load());
+}
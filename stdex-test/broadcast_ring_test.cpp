@@ -0,0 +1,106 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <stdex/broadcast_ring.h>
+
+TEST(broadcast_ring, every_reader_sees_every_element)
+{
+    auto r = stdex::broadcast_ring<int, 8>();
+    auto a = r.subscribe();
+    auto b = r.subscribe();
+
+    r.push_back(1);
+    r.push_back(2);
+
+    auto v = 0;
+    EXPECT_TRUE(a.try_pop(v));
+    EXPECT_EQ(1, v);
+    EXPECT_TRUE(a.try_pop(v));
+    EXPECT_EQ(2, v);
+    EXPECT_FALSE(a.try_pop(v));
+
+    EXPECT_EQ(2u, b.available());
+    EXPECT_TRUE(b.try_pop(v));
+    EXPECT_EQ(1, v);
+}
+
+TEST(broadcast_ring, subscribe_late)
+{
+    auto r = stdex::broadcast_ring<int, 4>();
+    for (auto i = 0; i < 6; i++)
+    {
+        r.push_back(i);
+    }
+
+    auto now = r.subscribe();
+    auto v = 0;
+    EXPECT_FALSE(now.try_pop(v));
+
+    auto oldest = r.subscribe_oldest();
+    auto values = std::vector<int>();
+    EXPECT_EQ(4u, oldest.try_pop(std::back_inserter(values), 10));
+    EXPECT_EQ((std::vector<int>{2, 3, 4, 5}), values);
+}
+
+TEST(broadcast_ring, lapped_reader)
+{
+    auto r = stdex::broadcast_ring<int, 4>();
+    auto slow = r.subscribe();
+    for (auto i = 0; i < 10; i++)
+    {
+        r.push_back(i);
+    }
+
+    auto v = 0;
+    EXPECT_TRUE(slow.try_pop(v));
+    EXPECT_EQ(6, v);
+    EXPECT_EQ(6u, slow.missed());
+    EXPECT_EQ(7u, slow.sequence());
+}
+
+TEST(broadcast_ring, concurrent_readers)
+{
+    constexpr auto count = 200000u;
+    auto r = stdex::broadcast_ring<unsigned, 1024>();
+
+    auto readers = std::vector<std::thread>();
+    for (auto i = 0; i < 3; i++)
+    {
+        readers.emplace_back([&, rd = r.subscribe()] () mutable {
+            // elements arrive in order and every skipped one is counted
+            auto received = 0u;
+            auto v = 0u;
+            while (rd.sequence() < count)
+            {
+                if (rd.try_pop(v))
+                {
+                    ASSERT_EQ(rd.sequence() - 1u, v);
+                    received++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+            EXPECT_EQ(count, received + rd.missed());
+        });
+    }
+
+    for (auto i = 0u; i < count; i++)
+    {
+        r.push_back(i);
+    }
+    for (auto& t : readers)
+    {
+        t.join();
+    }
+}
@@ -0,0 +1,289 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <stdex/channel.h>
+
+TEST(channel, default_contructor)
+{
+    auto c = stdex::channel<int, 4>();
+    EXPECT_TRUE(c.empty());
+    EXPECT_FALSE(c.closed());
+    EXPECT_EQ(4u, c.capacity());
+}
+
+TEST(channel, try_push_pop)
+{
+    auto c = stdex::channel<int, 2>();
+    EXPECT_TRUE(c.try_push(1));
+    EXPECT_TRUE(c.try_push(2));
+    EXPECT_FALSE(c.try_push(3));
+    EXPECT_EQ(2u, c.size());
+
+    EXPECT_EQ(std::optional<int>(1), c.try_pop());
+    EXPECT_EQ(std::optional<int>(2), c.try_pop());
+    EXPECT_EQ(std::nullopt, c.try_pop());
+}
+
+TEST(channel, force_push_evicts_oldest)
+{
+    auto c = stdex::channel<int, 2>();
+    EXPECT_TRUE(c.force_push(1));
+    EXPECT_TRUE(c.force_push(2));
+    EXPECT_TRUE(c.force_push(3));
+
+    auto values = std::vector<int>();
+    EXPECT_EQ(2u, c.try_pop_n(std::back_inserter(values), 10));
+    EXPECT_EQ(std::vector<int>({2, 3}), values);
+}
+
+TEST(channel, async_pop_parks_until_push)
+{
+    auto c = stdex::channel<int, 2>();
+    auto result = std::optional<int>();
+    c.async_pop([&] (std::optional<int> v) { result = v; });
+    EXPECT_EQ(std::nullopt, result);
+
+    EXPECT_TRUE(c.try_push(42));
+    EXPECT_EQ(std::optional<int>(42), result);
+    // handed over, never buffered
+    EXPECT_TRUE(c.empty());
+}
+
+TEST(channel, async_push_parks_until_pop)
+{
+    auto c = stdex::channel<int, 1>();
+    auto pushed = std::vector<bool>();
+    c.async_push(1, [&] (bool ok) { pushed.push_back(ok); });
+    c.async_push(2, [&] (bool ok) { pushed.push_back(ok); });
+    EXPECT_EQ(std::vector<bool>({true}), pushed);
+
+    EXPECT_EQ(std::optional<int>(1), c.try_pop());
+    EXPECT_EQ(std::vector<bool>({true, true}), pushed);
+    EXPECT_EQ(std::optional<int>(2), c.try_pop());
+}
+
+TEST(channel, pops_in_order)
+{
+    auto c = stdex::channel<int, 1>();
+    auto values = std::vector<int>();
+    for (auto i = 0; i < 3; i++)
+    {
+        c.async_pop([&] (std::optional<int> v) { values.push_back(*v); });
+    }
+    for (auto i = 0; i < 3; i++)
+    {
+        c.try_push(i);
+    }
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), values);
+}
+
+TEST(channel, close_completes_parked)
+{
+    auto c = stdex::channel<int, 1>();
+    auto pushed = std::vector<bool>();
+    c.async_push(1, [&] (bool ok) { pushed.push_back(ok); });
+    c.async_push(2, [&] (bool ok) { pushed.push_back(ok); });
+    c.close();
+    EXPECT_EQ(std::vector<bool>({true, false}), pushed);
+    EXPECT_FALSE(c.try_push(3));
+
+    // buffered values are still delivered
+    auto results = std::vector<std::optional<int>>();
+    c.async_pop([&] (std::optional<int> v) { results.push_back(v); });
+    c.async_pop([&] (std::optional<int> v) { results.push_back(v); });
+    EXPECT_EQ(std::vector<std::optional<int>>({1, std::nullopt}), results);
+}
+
+TEST(channel, destructor_closes)
+{
+    auto result = std::optional<int>(0);
+    auto called = false;
+    {
+        auto c = stdex::channel<int, 1>();
+        c.async_pop([&] (std::optional<int> v) { result = v; called = true; });
+    }
+    EXPECT_TRUE(called);
+    EXPECT_EQ(std::nullopt, result);
+}
+
+TEST(channel, executor_defers_completion)
+{
+    auto queue = std::deque<std::function<void ()>>();
+    auto c = stdex::channel<int, 1>([&] (std::function<void ()> fn) { queue.push_back(std::move(fn)); });
+
+    auto result = std::optional<int>();
+    c.async_pop([&] (std::optional<int> v) { result = v; });
+    c.try_push(7);
+    EXPECT_EQ(std::nullopt, result);
+    ASSERT_EQ(1u, queue.size());
+
+    queue.front()();
+    EXPECT_EQ(std::optional<int>(7), result);
+}
+
+TEST(channel, move_only)
+{
+    auto c = stdex::channel<std::unique_ptr<int>, 1>();
+    auto result = std::unique_ptr<int>();
+    c.async_pop([&] (std::optional<std::unique_ptr<int>> v) { result = std::move(*v); });
+    c.try_push(std::make_unique<int>(5));
+    ASSERT_NE(nullptr, result);
+    EXPECT_EQ(5, *result);
+}
+
+TEST(channel, immediate_callbacks_run_inline)
+{
+    auto queue = std::deque<std::function<void ()>>();
+    auto c = stdex::channel<int, 1>([&] (std::function<void ()> fn) { queue.push_back(std::move(fn)); });
+
+    auto pushed = false;
+    c.async_push(3, [&] (bool ok) { pushed = ok; });
+    EXPECT_TRUE(pushed);
+
+    auto result = std::optional<int>();
+    c.async_pop([&] (std::optional<int> v) { result = v; });
+    EXPECT_EQ(std::optional<int>(3), result);
+    EXPECT_TRUE(queue.empty());
+
+    c.close();
+    pushed = true;
+    c.async_push(4, [&] (bool ok) { pushed = ok; });
+    EXPECT_FALSE(pushed);
+    c.async_pop([&] (std::optional<int> v) { result = v; });
+    EXPECT_EQ(std::nullopt, result);
+}
+
+TEST(channel, failed_push_keeps_value)
+{
+    auto c = stdex::channel<std::unique_ptr<int>, 1>();
+    EXPECT_TRUE(c.try_push(std::make_unique<int>(1)));
+
+    auto value = std::make_unique<int>(2);
+    EXPECT_FALSE(c.try_push(std::move(value)));
+    ASSERT_NE(nullptr, value);
+    EXPECT_EQ(2, *value);
+
+    c.close();
+    EXPECT_FALSE(c.try_push(std::move(value)));
+    EXPECT_FALSE(c.force_push(std::move(value)));
+    ASSERT_NE(nullptr, value);
+    EXPECT_EQ(2, *value);
+    EXPECT_EQ(1, **c.try_pop());
+}
+
+TEST(channel, threaded_pipeline)
+{
+    constexpr auto count = 10000;
+    auto c = stdex::channel<int, 16>();
+    auto sum = std::atomic<long long>(0);
+    auto received = std::atomic<int>(0);
+
+    // the consumer re-arms itself from the completion
+    std::function<void (std::optional<int>)> receive = [&] (std::optional<int> v) {
+        if (v)
+        {
+            sum += *v;
+            received++;
+            c.async_pop(receive);
+        }
+    };
+    c.async_pop(receive);
+
+    auto producer = std::thread([&] () {
+        for (auto i = 1; i <= count; i++)
+        {
+            while (!c.try_push(i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    producer.join();
+    while (received < count)
+    {
+        std::this_thread::yield();
+    }
+    c.close();
+
+    EXPECT_EQ(count * (count + 1ll) / 2, sum);
+}
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+namespace
+{
+    struct detached
+    {
+        struct promise_type
+        {
+            detached get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    detached produce(stdex::channel<int, 2>& c, int n)
+    {
+        for (auto i = 0; i < n; i++)
+        {
+            co_await c.push(i);
+        }
+        c.close();
+    }
+
+    detached consume(stdex::channel<int, 2>& c, std::vector<int>& values)
+    {
+        while (auto v = co_await c.pop())
+        {
+            values.push_back(*v);
+        }
+    }
+
+    detached consume_batches(stdex::channel<int, 2>& c, std::vector<int>& values, std::vector<std::size_t>& batches)
+    {
+        while (auto n = co_await c.pop_batch(std::back_inserter(values), 4))
+        {
+            batches.push_back(n);
+        }
+    }
+}
+
+TEST(channel, coroutine_push_pop)
+{
+    auto c = stdex::channel<int, 2>();
+    auto values = std::vector<int>();
+    consume(c, values);
+    produce(c, 10);
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), values);
+}
+
+TEST(channel, coroutine_pop_batch)
+{
+    auto c = stdex::channel<int, 2>();
+    auto values  = std::vector<int>();
+    auto batches = std::vector<std::size_t>();
+    c.try_push(0);
+    c.try_push(1);
+    consume_batches(c, values, batches);
+    produce(c, 3);
+    EXPECT_EQ(std::vector<int>({0, 1, 0, 1, 2}), values);
+    EXPECT_EQ(2u, batches.front());
+}
+
+#endif
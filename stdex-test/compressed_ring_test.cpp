@@ -0,0 +1,200 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include <stdex/compressed_ring.h>
+
+TEST(compressed_ring, default_contructor)
+{
+    auto r = stdex::compressed_ring<double, 10>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+    EXPECT_EQ(0u, r.block_count());
+    EXPECT_EQ(r.begin(), r.end());
+}
+
+TEST(compressed_ring, push_back)
+{
+    auto r = stdex::compressed_ring<double, 10>();
+    r.push_back(1.5);
+    r.push_back(1.5);
+    r.push_back(-2.25);
+
+    auto values = std::vector<double>(r.begin(), r.end());
+    auto ref    = std::vector<double>{1.5, 1.5, -2.25};
+    EXPECT_EQ(ref, values);
+    EXPECT_EQ(1.5, r.front());
+    EXPECT_EQ(-2.25, r.back());
+}
+
+TEST(compressed_ring, input_iterator)
+{
+    using iter = stdex::compressed_ring<int, 10>::const_iterator;
+    EXPECT_TRUE((std::is_same_v<std::input_iterator_tag, std::iterator_traits<iter>::iterator_category>));
+
+    auto r = stdex::compressed_ring<int, 10>{1, 2, 3};
+    auto i = r.begin();
+    EXPECT_EQ(1, *i++);
+    EXPECT_EQ(2, *i);
+    ++i;
+    EXPECT_EQ(3, *i);
+    EXPECT_EQ(r.end(), ++i);
+}
+
+TEST(compressed_ring, evicts_whole_blocks)
+{
+    auto r = stdex::compressed_ring<std::int64_t, 10, 4>();
+    for (auto i = 0; i < 25; i++)
+    {
+        r.push_back(i);
+    }
+
+    // only the last 10 are visible, the front block holds 3 evicted samples
+    EXPECT_EQ(10u, r.size());
+    EXPECT_EQ(4u, r.block_count());
+    EXPECT_EQ(15, r.front());
+    EXPECT_EQ(24, r.back());
+    auto values = std::vector<std::int64_t>(r.begin(), r.end());
+    auto ref    = std::vector<std::int64_t>{15, 16, 17, 18, 19, 20, 21, 22, 23, 24};
+    EXPECT_EQ(ref, values);
+}
+
+TEST(compressed_ring, double_round_trip)
+{
+    auto gen  = std::mt19937_64(42);
+    auto dist = std::normal_distribution<double>(100.0, 15.0);
+
+    auto r   = stdex::compressed_ring<double, 5000, 128>();
+    auto ref = std::deque<double>();
+    for (auto i = 0; i < 12345; i++)
+    {
+        // mix repeats, small changes, noise and special values
+        auto v = i % 7 == 0 ? ref.empty() ? 0.0 : ref.back() : dist(gen);
+        if (i % 1000 == 500)
+        {
+            v = std::numeric_limits<double>::infinity();
+        }
+        if (i % 1000 == 501)
+        {
+            v = -0.0;
+        }
+        r.push_back(v);
+        ref.push_back(v);
+        if (ref.size() > 5000)
+        {
+            ref.pop_front();
+        }
+    }
+
+    ASSERT_EQ(ref.size(), r.size());
+    auto i = ref.begin();
+    for (auto v : r)
+    {
+        EXPECT_EQ(0, std::memcmp(&v, &*i, sizeof(v)));
+        ++i;
+    }
+}
+
+TEST(compressed_ring, float_round_trip)
+{
+    auto r   = stdex::compressed_ring<float, 100, 16>();
+    auto ref = std::vector<float>();
+    for (auto i = 0; i < 100; i++)
+    {
+        auto v = std::sin(static_cast<float>(i) * 0.1f) * 1000.0f;
+        r.push_back(v);
+        ref.push_back(v);
+    }
+    auto values = std::vector<float>(r.begin(), r.end());
+    EXPECT_EQ(ref, values);
+}
+
+TEST(compressed_ring, integer_round_trip)
+{
+    auto r   = stdex::compressed_ring<std::int64_t, 1000, 64>();
+    auto ref = std::vector<std::int64_t>();
+    auto gen = std::mt19937_64(7);
+    auto t   = std::int64_t(1600000000000);
+    for (auto i = 0; i < 1000; i++)
+    {
+        // timestamps with jitter, the odd large jump and the extremes
+        t += 1000 + static_cast<std::int64_t>(gen() % 5) - 2;
+        auto v = t;
+        if (i % 100 == 17)
+        {
+            v = std::numeric_limits<std::int64_t>::min();
+        }
+        if (i % 100 == 18)
+        {
+            v = std::numeric_limits<std::int64_t>::max();
+        }
+        r.push_back(v);
+        ref.push_back(v);
+    }
+    auto values = std::vector<std::int64_t>(r.begin(), r.end());
+    EXPECT_EQ(ref, values);
+
+    auto small = stdex::compressed_ring<std::uint32_t, 4>{5u, 3u, 0xffffffffu, 0u, 7u};
+    auto svalues = std::vector<std::uint32_t>(small.begin(), small.end());
+    auto sref    = std::vector<std::uint32_t>{3u, 0xffffffffu, 0u, 7u};
+    EXPECT_EQ(sref, svalues);
+}
+
+TEST(compressed_ring, compression)
+{
+    const auto count = 100000u;
+
+    // a gauge that mostly repeats and moves in small steps
+    auto gauge = stdex::compressed_ring<double, count>();
+    auto level = 50.0;
+    for (auto i = 0u; i < count; i++)
+    {
+        if (i % 10 == 0)
+        {
+            level += (i % 20 == 0) ? 0.5 : -0.25;
+        }
+        gauge.push_back(level);
+    }
+    EXPECT_LT(gauge.memory_usage() * 5, count * sizeof(double));
+
+    // timestamps at a steady rate
+    auto times = stdex::compressed_ring<std::int64_t, count>();
+    for (auto i = 0u; i < count; i++)
+    {
+        times.push_back(1600000000000 + i * 1000);
+    }
+    EXPECT_LT(times.memory_usage() * 10, count * sizeof(std::int64_t));
+}
+
+TEST(compressed_ring, copy_and_clear)
+{
+    auto r = stdex::compressed_ring<int, 8, 3>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    auto c = r;
+    r.clear();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.block_count());
+
+    auto values = std::vector<int>(c.begin(), c.end());
+    auto ref    = std::vector<int>{3, 4, 5, 6, 7, 8, 9, 10};
+    EXPECT_EQ(ref, values);
+
+    swap(r, c);
+    EXPECT_TRUE(c.empty());
+    EXPECT_EQ(8u, r.size());
+}
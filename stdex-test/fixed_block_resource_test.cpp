@@ -0,0 +1,108 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <memory_resource>
+#include <set>
+#include <vector>
+#include <stdex/fixed_block_resource.h>
+#include <stdex/ring.h>
+
+namespace
+{
+    //! Counts the allocations passed through to the default resource.
+    class counting_resource : public std::pmr::memory_resource
+    {
+    public:
+        std::size_t allocations   = 0;
+        std::size_t deallocations = 0;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t align) override
+        {
+            allocations++;
+            return std::pmr::new_delete_resource()->allocate(bytes, align);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t align) override
+        {
+            deallocations++;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+}
+
+TEST(fixed_block_resource, allocate)
+{
+    auto upstream = counting_resource();
+    auto res      = stdex::fixed_block_resource(32, 4, &upstream);
+    EXPECT_EQ(32u, res.block_size());
+    EXPECT_EQ(&upstream, res.upstream_resource());
+
+    auto blocks = std::set<void*>();
+    for (auto i = 0; i < 4; i++)
+    {
+        blocks.insert(res.allocate(32));
+    }
+    EXPECT_EQ(4u, blocks.size());
+    EXPECT_EQ(1u, res.chunk_count());
+    EXPECT_EQ(1u, upstream.allocations);
+
+    // freed blocks are reused before a new chunk is requested
+    auto p = *blocks.begin();
+    res.deallocate(p, 32);
+    EXPECT_EQ(p, res.allocate(16));
+    EXPECT_EQ(1u, res.chunk_count());
+
+    EXPECT_NE(nullptr, res.allocate(32));
+    EXPECT_EQ(2u, res.chunk_count());
+
+    res.release();
+    EXPECT_EQ(0u, res.chunk_count());
+    EXPECT_EQ(upstream.allocations, upstream.deallocations);
+}
+
+TEST(fixed_block_resource, large_requests_go_upstream)
+{
+    auto upstream = counting_resource();
+    auto res      = stdex::fixed_block_resource(32, 4, &upstream);
+
+    auto p = res.allocate(100);
+    EXPECT_EQ(0u, res.chunk_count());
+    EXPECT_EQ(1u, upstream.allocations);
+    res.deallocate(p, 100);
+    EXPECT_EQ(1u, upstream.deallocations);
+}
+
+TEST(fixed_block_resource, backs_pmr_rings)
+{
+    auto upstream = counting_resource();
+    {
+        auto res = stdex::fixed_block_resource(stdex::deque_chunk_size<int>(), 16, &upstream);
+        for (auto i = 0; i < 1000; i++)
+        {
+            auto rng = stdex::pmr::ring<int, 100>(&res);
+            for (auto j = 0; j < 250; j++)
+            {
+                rng.push_back(j);
+            }
+            EXPECT_EQ(150, rng.front());
+        }
+
+        // the chunks of the first rings are recycled by the later ones
+        EXPECT_LT(upstream.allocations, 100u);
+    }
+    EXPECT_EQ(upstream.allocations, upstream.deallocations);
+}
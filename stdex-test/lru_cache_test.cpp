@@ -0,0 +1,208 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <list>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <stdex/lru_cache.h>
+
+TEST(lru_cache, default_contructor)
+{
+    auto c = stdex::lru_cache<int, int, 10>();
+    EXPECT_TRUE(c.empty());
+    EXPECT_EQ(0u, c.size());
+    EXPECT_EQ(10u, c.capacity());
+    EXPECT_EQ(nullptr, c.find(1));
+}
+
+TEST(lru_cache, insert_and_find)
+{
+    auto c = stdex::lru_cache<int, std::string, 4>();
+    c.insert_or_assign(1, "one");
+    c.insert_or_assign(2, "two");
+    EXPECT_EQ(2u, c.size());
+
+    auto v = c.find(1);
+    ASSERT_NE(nullptr, v);
+    EXPECT_EQ("one", *v);
+
+    c.insert_or_assign(1, "uno");
+    EXPECT_EQ(2u, c.size());
+    EXPECT_EQ("uno", *c.find(1));
+}
+
+TEST(lru_cache, evicts_least_recently_used)
+{
+    auto c = stdex::lru_cache<int, int, 3>();
+    c.insert_or_assign(1, 10);
+    c.insert_or_assign(2, 20);
+    c.insert_or_assign(3, 30);
+    // 1 becomes the most recently used, so 2 is evicted next
+    c.find(1);
+    c.insert_or_assign(4, 40);
+
+    EXPECT_EQ(3u, c.size());
+    EXPECT_FALSE(c.contains(2));
+    EXPECT_TRUE(c.contains(1));
+    EXPECT_TRUE(c.contains(3));
+    EXPECT_TRUE(c.contains(4));
+    EXPECT_EQ(1u, c.evictions());
+
+    auto order = std::vector<int>();
+    c.for_each([&] (const std::pair<const int, int>& e) { order.push_back(e.first); });
+    EXPECT_EQ(std::vector<int>({4, 1, 3}), order);
+}
+
+TEST(lru_cache, peek_does_not_touch)
+{
+    auto c = stdex::lru_cache<int, int, 2>();
+    c.insert_or_assign(1, 10);
+    c.insert_or_assign(2, 20);
+    EXPECT_EQ(10, *c.peek(1));
+    c.insert_or_assign(3, 30);
+    EXPECT_FALSE(c.contains(1));
+    EXPECT_EQ(0u, c.hits() + c.misses());
+}
+
+TEST(lru_cache, counters)
+{
+    auto c = stdex::lru_cache<int, int, 2>();
+    c.insert_or_assign(1, 10);
+    c.find(1);
+    c.find(1);
+    c.find(2);
+    EXPECT_EQ(2u, c.hits());
+    EXPECT_EQ(1u, c.misses());
+    EXPECT_EQ(0u, c.evictions());
+
+    c.reset_stats();
+    EXPECT_EQ(0u, c.hits());
+    EXPECT_EQ(0u, c.misses());
+}
+
+TEST(lru_cache, erase)
+{
+    auto c = stdex::lru_cache<int, int, 4>();
+    c.insert_or_assign(1, 10);
+    c.insert_or_assign(2, 20);
+    EXPECT_TRUE(c.erase(1));
+    EXPECT_FALSE(c.erase(1));
+    EXPECT_EQ(1u, c.size());
+    EXPECT_FALSE(c.contains(1));
+    EXPECT_TRUE(c.contains(2));
+
+    c.clear();
+    EXPECT_TRUE(c.empty());
+    EXPECT_FALSE(c.contains(2));
+}
+
+TEST(lru_cache, heterogeneous_lookup)
+{
+    auto c = stdex::lru_cache<std::string, int, 4>();
+    c.insert_or_assign("alpha", 1);
+    c.insert_or_assign("beta", 2);
+
+    auto text = std::string("xxbetaxx");
+    auto view = stdex::array_view<char>(text.data() + 2, 4);
+    auto v    = c.find(view);
+    ASSERT_NE(nullptr, v);
+    EXPECT_EQ(2, *v);
+
+    EXPECT_TRUE(c.contains(std::string_view("alpha")));
+    EXPECT_TRUE(c.contains("alpha"));
+    EXPECT_FALSE(c.contains(stdex::array_view<char>(text.data(), 4)));
+    EXPECT_TRUE(c.erase(view));
+    EXPECT_EQ(1u, c.size());
+}
+
+TEST(lru_cache, matches_reference)
+{
+    // colliding keys exercise probing and the backward shift on removal
+    struct bad_hash
+    {
+        std::size_t operator () (int key) const noexcept
+        {
+            return static_cast<std::size_t>(key % 7);
+        }
+    };
+
+    auto rng = std::mt19937(7);
+    auto c   = stdex::lru_cache<int, int, 8, bad_hash, std::equal_to<int>>();
+    auto ref = std::list<std::pair<int, int>>();
+    for (auto n = 0; n < 20000; n++)
+    {
+        auto key = static_cast<int>(rng() % 24);
+        auto it  = std::find_if(ref.begin(), ref.end(), [&] (const auto& e) { return e.first == key; });
+        switch (rng() % 3)
+        {
+            case 0:
+            {
+                auto v = c.find(key);
+                ASSERT_EQ(it != ref.end(), v != nullptr);
+                if (it != ref.end())
+                {
+                    EXPECT_EQ(it->second, *v);
+                    ref.splice(ref.begin(), ref, it);
+                }
+                break;
+            }
+            case 1:
+                c.insert_or_assign(key, n);
+                if (it != ref.end())
+                {
+                    ref.erase(it);
+                }
+                ref.emplace_front(key, n);
+                if (ref.size() > 8)
+                {
+                    ref.pop_back();
+                }
+                break;
+            default:
+                EXPECT_EQ(it != ref.end(), c.erase(key));
+                if (it != ref.end())
+                {
+                    ref.erase(it);
+                }
+                break;
+        }
+        ASSERT_EQ(ref.size(), c.size());
+    }
+
+    auto order = std::vector<std::pair<int, int>>();
+    c.for_each([&] (const std::pair<const int, int>& e) { order.emplace_back(e.first, e.second); });
+    auto expected = std::vector<std::pair<int, int>>(ref.begin(), ref.end());
+    EXPECT_EQ(expected, order);
+}
+
+TEST(lru_cache, strided_keys)
+{
+    // std::hash of an integer is the integer itself in some libraries, so
+    // these keys would share one probe chain without mixing the hash
+    constexpr auto capacity = 512u;
+    auto c = stdex::lru_cache<std::size_t, std::size_t, capacity>();
+    for (auto i = std::size_t(0); i < 4 * capacity; i++)
+    {
+        c.insert_or_assign(i * 1024, i);
+    }
+    EXPECT_EQ(capacity, c.size());
+    EXPECT_EQ(3 * capacity, c.evictions());
+    for (auto i = 3 * capacity; i < 4 * capacity; i++)
+    {
+        auto v = c.find(i * 1024);
+        ASSERT_NE(nullptr, v);
+        EXPECT_EQ(i, *v);
+    }
+    EXPECT_FALSE(c.contains(0));
+}
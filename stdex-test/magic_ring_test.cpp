@@ -0,0 +1,128 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include <stdex/magic_ring.h>
+#include <stdex/algorithm.h>
+
+TEST(magic_ring, default_contructor)
+{
+    auto r = stdex::magic_ring<int, 10>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+}
+
+TEST(magic_ring, roll_over_forward)
+{
+    auto r = stdex::magic_ring<int, 1024>();
+    for (auto i = 0; i < 5000; i++)
+    {
+        r.push_back(i);
+    }
+    EXPECT_EQ(1024u, r.size());
+    EXPECT_EQ(5000 - 1024, r.front());
+    EXPECT_EQ(4999, r.back());
+
+    // the contents are always contiguous
+    auto view = r.view();
+    for (auto i = 0u; i < view.size(); i++)
+    {
+        EXPECT_EQ(static_cast<int>(5000 - 1024 + i), view[i]);
+    }
+}
+
+TEST(magic_ring, roll_over_backward)
+{
+    auto r = stdex::magic_ring<int, 10>();
+    for (auto i = 0; i < 20; i++)
+    {
+        r.push_front(i);
+    }
+    EXPECT_EQ(10u, r.size());
+    EXPECT_EQ(19, r.front());
+    EXPECT_EQ(10, r.back());
+
+    auto ref = std::vector<int>{19, 18, 17, 16, 15, 14, 13, 12, 11, 10};
+    EXPECT_TRUE(stdex::equals(begin(r), end(r), begin(ref), end(ref)));
+}
+
+TEST(magic_ring, wrap_is_contiguous)
+{
+    // exactly one page, so the storage wraps at the capacity
+    auto r = stdex::magic_ring<char, 4096>();
+    auto text = std::vector<char>(4000, 'a');
+    r.append(stdex::array_view<char>(text));
+    for (auto i = 0; i < 4000; i++)
+    {
+        r.pop_front();
+    }
+
+    const char* message = "hello across the seam";
+    r.append(stdex::array_view<char>(message, std::strlen(message)));
+
+    auto view = r.view();
+    EXPECT_EQ(std::strlen(message), view.size());
+    EXPECT_EQ(0, std::memcmp(message, view.data(), view.size()));
+}
+
+TEST(magic_ring, append_to_large)
+{
+    auto r = stdex::magic_ring<int, 5>{0, 1, 2};
+    auto values = std::vector<int>{3, 4, 5, 6, 7, 8, 9, 10};
+    r.append(stdex::array_view<int>(values));
+
+    auto ref = std::vector<int>{6, 7, 8, 9, 10};
+    EXPECT_TRUE(stdex::equals(begin(r), end(r), begin(ref), end(ref)));
+}
+
+TEST(magic_ring, append_empty)
+{
+    auto r = stdex::magic_ring<int, 5>{0, 1, 2};
+    r.append(stdex::array_view<int>());
+
+    auto ref = std::vector<int>{0, 1, 2};
+    EXPECT_TRUE(stdex::equals(begin(r), end(r), begin(ref), end(ref)));
+}
+
+TEST(magic_ring, insert)
+{
+    auto r = stdex::magic_ring<int, 10>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    r.insert(r.begin() + 5, 99);
+
+    auto ref = std::vector<int>{0, 1, 2, 3, 4, 99, 5, 6, 7, 8};
+    EXPECT_TRUE(stdex::equals(begin(r), end(r), begin(ref), end(ref)));
+}
+
+TEST(magic_ring, free_span)
+{
+    auto r = stdex::magic_ring<int, 8>{0, 1, 2, 3, 4, 5};
+    auto span = r.free_span();
+    EXPECT_EQ(2u, span.size());
+    span[0] = 6;
+    span[1] = 7;
+    r.commit(2);
+
+    auto ref = std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7};
+    EXPECT_TRUE(stdex::equals(begin(r), end(r), begin(ref), end(ref)));
+}
+
+TEST(magic_ring, copy_and_swap)
+{
+    auto a = stdex::magic_ring<int, 10>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    auto b = a;
+    auto c = stdex::magic_ring<int, 10>{};
+    swap(a, c);
+
+    EXPECT_EQ(0u, a.size());
+    EXPECT_TRUE(stdex::equals(begin(b), end(b), begin(c), end(c)));
+}
@@ -0,0 +1,158 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdex/mpmc_ring.h>
+
+TEST(mpmc_ring, default_contructor)
+{
+    auto r = stdex::mpmc_ring<int, 10>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+}
+
+TEST(mpmc_ring, push_pop)
+{
+    auto r = stdex::mpmc_ring<int, 3>();
+    EXPECT_TRUE(r.try_push(1));
+    EXPECT_TRUE(r.try_push(2));
+    EXPECT_TRUE(r.try_push(3));
+    EXPECT_FALSE(r.try_push(4));
+    EXPECT_EQ(3u, r.size());
+
+    auto v = 0;
+    EXPECT_TRUE(r.try_pop(v));
+    EXPECT_EQ(1, v);
+    EXPECT_TRUE(r.try_push(4));
+
+    for (auto ref : {2, 3, 4})
+    {
+        EXPECT_TRUE(r.try_pop(v));
+        EXPECT_EQ(ref, v);
+    }
+    EXPECT_FALSE(r.try_pop(v));
+}
+
+TEST(mpmc_ring, smallest_capacity)
+{
+    // two slots are the minimum; full and empty must stay apart over many laps
+    auto r = stdex::mpmc_ring<int, 2>();
+    for (auto i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(r.try_push(2 * i));
+        EXPECT_TRUE(r.try_push(2 * i + 1));
+        EXPECT_FALSE(r.try_push(-1));
+
+        auto v = 0;
+        EXPECT_TRUE(r.try_pop(v));
+        EXPECT_EQ(2 * i, v);
+        EXPECT_TRUE(r.try_pop(v));
+        EXPECT_EQ(2 * i + 1, v);
+        EXPECT_FALSE(r.try_pop(v));
+    }
+}
+
+TEST(mpmc_ring, move_only)
+{
+    auto r = stdex::mpmc_ring<std::unique_ptr<std::string>, 4>();
+    EXPECT_TRUE(r.try_push(std::make_unique<std::string>("one")));
+    r.emplace(new std::string("two"));
+
+    auto v = std::unique_ptr<std::string>();
+    r.pop(v);
+    EXPECT_EQ("one", *v);
+
+    // the remaining element is destroyed with the ring
+}
+
+TEST(mpmc_ring, blocking)
+{
+    auto r = stdex::mpmc_ring<int, 2>();
+    auto consumer = std::thread([&] () {
+        for (auto i = 0; i < 100; i++)
+        {
+            auto v = -1;
+            r.pop(v);
+            EXPECT_EQ(i, v);
+        }
+    });
+    for (auto i = 0; i < 100; i++)
+    {
+        r.push(i);
+    }
+    consumer.join();
+    EXPECT_TRUE(r.empty());
+}
+
+TEST(mpmc_ring, stress)
+{
+    constexpr auto per_producer = 100000ull;
+    auto max_threads = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+
+    for (auto threads = 1u; threads <= max_threads; threads++)
+    {
+        auto r = stdex::mpmc_ring<unsigned long long, 256>();
+        auto consumed = std::atomic<unsigned long long>{0};
+        auto sum      = std::atomic<unsigned long long>{0};
+        auto total    = per_producer * threads;
+
+        auto start = std::chrono::steady_clock::now();
+        auto workers = std::vector<std::thread>();
+        for (auto p = 0u; p < threads; p++)
+        {
+            workers.emplace_back([&, p] () {
+                for (auto i = 0ull; i < per_producer; i++)
+                {
+                    r.push(p * per_producer + i);
+                }
+            });
+            workers.emplace_back([&] () {
+                // each consumer sees the values of one producer in order
+                auto last = std::vector<unsigned long long>(threads, 0);
+                auto local_sum = 0ull;
+                auto v = 0ull;
+                while (consumed.load() < total)
+                {
+                    if (r.try_pop(v))
+                    {
+                        auto producer = v / per_producer;
+                        auto value    = v % per_producer + 1;
+                        EXPECT_LT(last[producer], value);
+                        last[producer] = value;
+                        local_sum += v;
+                        consumed++;
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                sum += local_sum;
+            });
+        }
+        for (auto& w : workers)
+        {
+            w.join();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+        EXPECT_EQ(total, consumed.load());
+        EXPECT_EQ(total * (total - 1) / 2, sum.load());
+        EXPECT_TRUE(r.empty());
+        RecordProperty("items_per_second_" + std::to_string(threads), static_cast<int>(total / elapsed.count()));
+    }
+}
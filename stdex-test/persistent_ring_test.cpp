@@ -0,0 +1,212 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <stdex/persistent_ring.h>
+
+namespace
+{
+    struct record
+    {
+        std::uint32_t id;
+        float         value;
+    };
+
+    //! A fresh file in the temp directory that is removed afterwards.
+    class temp_file
+    {
+    public:
+        explicit temp_file(const std::string& name)
+        : path((std::filesystem::temp_directory_path() / name).string())
+        {
+            std::filesystem::remove(path);
+        }
+
+        ~temp_file()
+        {
+            std::filesystem::remove(path);
+        }
+
+        const std::string path;
+    };
+
+    void push_and_abort(const std::string& path)
+    {
+        auto r = stdex::persistent_ring<int, 16>(path);
+        for (auto i = 0; i < 20; i++)
+        {
+            r.push_back(i);
+        }
+        std::abort();
+    }
+}
+
+TEST(persistent_ring, create)
+{
+    auto file = temp_file("stdex-persistent-ring-create");
+    auto r = stdex::persistent_ring<int, 10>(file.path);
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+    EXPECT_TRUE(std::filesystem::exists(file.path));
+}
+
+TEST(persistent_ring, push_back)
+{
+    auto file = temp_file("stdex-persistent-ring-push");
+    auto r = stdex::persistent_ring<int, 4>(file.path);
+    for (auto i = 0; i < 6; i++)
+    {
+        r.push_back(i);
+    }
+
+    EXPECT_EQ(4u, r.size());
+    EXPECT_EQ(2, r.front());
+    EXPECT_EQ(5, r.back());
+    EXPECT_EQ(2u, r.oldest_sequence());
+    EXPECT_EQ(6u, r.next_sequence());
+    auto values = std::vector<int>(r.begin(), r.end());
+    auto ref    = std::vector<int>{2, 3, 4, 5};
+    EXPECT_EQ(ref, values);
+
+    auto segs = r.segments();
+    EXPECT_EQ(2u, segs[0].size());
+    EXPECT_EQ(2u, segs[1].size());
+
+    r.pop_front();
+    EXPECT_EQ(3, r.front());
+    r.clear();
+    EXPECT_TRUE(r.empty());
+}
+
+TEST(persistent_ring, reopen)
+{
+    auto file = temp_file("stdex-persistent-ring-reopen");
+    {
+        auto r = stdex::persistent_ring<record, 8>(file.path, 4);
+        for (auto i = 0u; i < 10; i++)
+        {
+            r.push_back({i, i * 0.5f});
+        }
+    }
+
+    auto r = stdex::persistent_ring<record, 8>(file.path);
+    ASSERT_EQ(8u, r.size());
+    EXPECT_EQ(2u, r.front().id);
+    EXPECT_EQ(9u, r.back().id);
+    EXPECT_EQ(4.5f, r.back().value);
+    EXPECT_EQ(10u, r.next_sequence());
+
+    r.push_back({10, 5.0f});
+    EXPECT_EQ(3u, r.front().id);
+}
+
+TEST(persistent_ring, survives_crash)
+{
+    auto file = temp_file("stdex-persistent-ring-crash");
+    EXPECT_DEATH(push_and_abort(file.path), "");
+
+    auto r = stdex::persistent_ring<int, 16>(file.path);
+    ASSERT_EQ(16u, r.size());
+    EXPECT_EQ(4, r.front());
+    EXPECT_EQ(19, r.back());
+}
+
+TEST(persistent_ring, incompatible_file)
+{
+    auto file = temp_file("stdex-persistent-ring-incompatible");
+    {
+        auto r = stdex::persistent_ring<int, 8>(file.path);
+        r.push_back(1);
+    }
+    EXPECT_THROW((stdex::persistent_ring<int, 16>(file.path)), std::runtime_error);
+    EXPECT_THROW((stdex::persistent_ring<double, 8>(file.path)), std::runtime_error);
+
+    {
+        auto out = std::ofstream(file.path, std::ios::binary | std::ios::trunc);
+        out << "not a ring file at all";
+    }
+    EXPECT_THROW((stdex::persistent_ring<int, 8>(file.path)), std::runtime_error);
+}
+
+TEST(persistent_ring, short_file_is_not_modified)
+{
+    auto file    = temp_file("stdex-persistent-ring-short");
+    auto content = std::string("some other file");
+    {
+        auto out = std::ofstream(file.path, std::ios::binary | std::ios::trunc);
+        out << content;
+    }
+    EXPECT_THROW((stdex::persistent_ring<int, 8>(file.path)), std::runtime_error);
+
+    auto in   = std::ifstream(file.path, std::ios::binary);
+    auto read = std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, read);
+}
+
+TEST(persistent_ring, zero_filled_file)
+{
+    auto file = temp_file("stdex-persistent-ring-zeros");
+
+    // a crash after growing the file leaves it zero filled at full size
+    {
+        auto out = std::ofstream(file.path, std::ios::binary | std::ios::trunc);
+        out << std::string(64 + 8 * sizeof(int), '\0');
+    }
+    {
+        auto r = stdex::persistent_ring<int, 8>(file.path);
+        EXPECT_TRUE(r.empty());
+        r.push_back(7);
+    }
+    {
+        auto r = stdex::persistent_ring<int, 8>(file.path);
+        EXPECT_EQ(7, r.front());
+    }
+
+    // zeros of any other size are not a ring
+    {
+        auto out = std::ofstream(file.path, std::ios::binary | std::ios::trunc);
+        out << std::string(4096, '\0');
+    }
+    EXPECT_THROW((stdex::persistent_ring<int, 8>(file.path)), std::runtime_error);
+    EXPECT_EQ(4096u, std::filesystem::file_size(file.path));
+}
+
+TEST(persistent_ring, full_size_foreign_file_is_not_modified)
+{
+    auto file    = temp_file("stdex-persistent-ring-foreign");
+    auto content = std::string(64 + 8 * sizeof(int), 'x');
+    {
+        auto out = std::ofstream(file.path, std::ios::binary | std::ios::trunc);
+        out << content;
+    }
+    EXPECT_THROW((stdex::persistent_ring<int, 8>(file.path)), std::runtime_error);
+
+    auto in   = std::ifstream(file.path, std::ios::binary);
+    auto read = std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, read);
+}
+
+TEST(persistent_ring, move)
+{
+    auto file = temp_file("stdex-persistent-ring-move");
+    auto a = stdex::persistent_ring<int, 4>(file.path);
+    a.push_back(42);
+    auto b = std::move(a);
+    EXPECT_EQ(42, b.front());
+    b.flush();
+}
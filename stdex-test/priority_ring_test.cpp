@@ -0,0 +1,122 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <stdex/priority_ring.h>
+
+TEST(priority_ring, default_contructor)
+{
+    auto r = stdex::priority_ring<int, 10>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+}
+
+TEST(priority_ring, keeps_highest)
+{
+    auto r = stdex::priority_ring<int, 3>{5, 1, 9, 3, 7, 2};
+    EXPECT_EQ(3u, r.size());
+    EXPECT_EQ(5, r.lowest());
+    EXPECT_EQ(std::vector<int>({9, 7, 5}), r.sorted());
+}
+
+TEST(priority_ring, rejects_low_priority)
+{
+    auto r = stdex::priority_ring<int, 2>{4, 8};
+    EXPECT_FALSE(r.accepts(3));
+    EXPECT_FALSE(r.push(3));
+    // ties keep the element already held
+    EXPECT_FALSE(r.push(4));
+    EXPECT_TRUE(r.push(5));
+    EXPECT_EQ(5, r.lowest());
+}
+
+TEST(priority_ring, custom_compare)
+{
+    auto r = stdex::priority_ring<int, 3, std::greater<int>>{5, 1, 9, 3, 7, 2};
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), r.sorted());
+}
+
+TEST(priority_ring, pop_lowest)
+{
+    auto r = stdex::priority_ring<int, 4>{6, 2, 8, 4};
+    r.pop();
+    EXPECT_EQ(4, r.lowest());
+    r.pop();
+    EXPECT_EQ(6, r.lowest());
+    r.clear();
+    EXPECT_TRUE(r.empty());
+    EXPECT_TRUE(r.accepts(0));
+}
+
+TEST(priority_ring, releases_popped_elements)
+{
+    auto value = std::make_shared<int>(1);
+    auto less  = [] (const std::shared_ptr<int>& a, const std::shared_ptr<int>& b) { return *a < *b; };
+    auto r     = stdex::priority_ring<std::shared_ptr<int>, 3, decltype(less)>(less);
+    r.push(value);
+    r.push(std::make_shared<int>(2));
+    EXPECT_EQ(2, value.use_count());
+    r.pop();
+    EXPECT_EQ(1, value.use_count());
+
+    r.push(value);
+    EXPECT_EQ(2, value.use_count());
+    r.clear();
+    EXPECT_EQ(1, value.use_count());
+}
+
+TEST(priority_ring, sorted_to_output_iterator)
+{
+    struct query
+    {
+        std::string text;
+        int         ms;
+    };
+    auto by_duration = [] (const query& a, const query& b) { return a.ms < b.ms; };
+
+    auto r = stdex::priority_ring<query, 2, decltype(by_duration)>(by_duration);
+    r.push({"a", 10});
+    r.push({"b", 300});
+    r.push({"c", 20});
+    r.push({"d", 150});
+
+    auto slowest = std::vector<std::string>();
+    auto out     = std::vector<query>();
+    r.sorted(std::back_inserter(out));
+    for (const auto& q : out)
+    {
+        slowest.push_back(q.text);
+    }
+    EXPECT_EQ(std::vector<std::string>({"b", "d"}), slowest);
+}
+
+TEST(priority_ring, matches_sort)
+{
+    auto rng = std::mt19937(42);
+    auto r   = stdex::priority_ring<unsigned int, 16>();
+    auto all = std::vector<unsigned int>();
+    for (auto i = 0; i < 1000; i++)
+    {
+        auto v = rng() % 500;
+        r.push(v);
+        all.push_back(v);
+    }
+
+    std::sort(all.begin(), all.end(), std::greater<unsigned int>());
+    all.resize(16);
+    EXPECT_EQ(all, r.sorted());
+}
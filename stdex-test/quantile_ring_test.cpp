@@ -0,0 +1,96 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <random>
+#include <vector>
+#include <stdex/quantile_ring.h>
+
+TEST(quantile_ring, default_contructor)
+{
+    auto r = stdex::quantile_ring<int, 10>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+}
+
+TEST(quantile_ring, median)
+{
+    auto r = stdex::quantile_ring<int, 5>{9, 1, 8, 2, 7};
+    EXPECT_EQ(7, r.median());
+    EXPECT_EQ(1, r.min());
+    EXPECT_EQ(9, r.max());
+
+    r.push_back(3);
+    EXPECT_EQ(3, r.median());
+    EXPECT_EQ(1, r.front());
+    EXPECT_EQ(3, r.back());
+}
+
+TEST(quantile_ring, percentiles)
+{
+    auto r = stdex::quantile_ring<int, 100>();
+    for (auto i = 1; i <= 300; i++)
+    {
+        r.push_back(i);
+    }
+    // window holds 201 to 300
+    EXPECT_EQ(250, r.quantile(0.5));
+    EXPECT_EQ(295, r.quantile(0.95));
+    EXPECT_EQ(299, r.quantile(0.99));
+    EXPECT_EQ(201, r.quantile(0.0));
+    EXPECT_EQ(300, r.quantile(1.0));
+}
+
+TEST(quantile_ring, duplicates)
+{
+    auto r = stdex::quantile_ring<int, 4>{5, 5, 5, 1};
+    r.push_back(5);
+    r.push_back(9);
+    EXPECT_EQ(1, r.nth(0));
+    EXPECT_EQ(5, r.nth(1));
+    EXPECT_EQ(5, r.nth(2));
+    EXPECT_EQ(9, r.nth(3));
+}
+
+TEST(quantile_ring, custom_compare)
+{
+    auto r = stdex::quantile_ring<int, 3, std::greater<int>>{1, 2, 3};
+    EXPECT_EQ(3, r.nth(0));
+    EXPECT_EQ(1, r.nth(2));
+}
+
+TEST(quantile_ring, matches_brute_force)
+{
+    auto rng  = std::mt19937(1);
+    auto dist = std::uniform_int_distribution<int>(0, 500);
+
+    auto r   = stdex::quantile_ring<int, 64>();
+    auto ref = std::deque<int>();
+    for (auto i = 0; i < 3000; i++)
+    {
+        auto v = dist(rng);
+        r.push_back(v);
+        ref.push_back(v);
+        if (ref.size() > 64u)
+        {
+            ref.pop_front();
+        }
+
+        auto sorted = std::vector<int>(begin(ref), end(ref));
+        std::sort(begin(sorted), end(sorted));
+        for (auto k = 0u; k < sorted.size(); k += 7)
+        {
+            ASSERT_EQ(sorted[k], r.nth(k));
+        }
+    }
+}
@@ -0,0 +1,154 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <stdex/record_ring.h>
+
+namespace
+{
+    template <std::size_t MS>
+    void push(stdex::record_ring<MS>& r, std::string_view text)
+    {
+        r.push(stdex::array_view<char>(text.data(), text.size()));
+    }
+
+    template <std::size_t MS>
+    std::string pop(stdex::record_ring<MS>& r)
+    {
+        auto record = r.peek();
+        auto result = std::string(record.data(), record.size());
+        r.release();
+        return result;
+    }
+}
+
+TEST(record_ring, default_contructor)
+{
+    auto r = stdex::record_ring<64>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(64u, r.capacity());
+    EXPECT_EQ(60u, r.max_record_size());
+    EXPECT_EQ(0u, r.bytes_used());
+}
+
+TEST(record_ring, push_and_pop)
+{
+    auto r = stdex::record_ring<64>();
+    push(r, "hello");
+    push(r, "");
+    push(r, "world!");
+    EXPECT_EQ(3u, r.size());
+    // 4 + 5 padded to 12, 4, 4 + 6 padded to 12
+    EXPECT_EQ(28u, r.bytes_used());
+
+    EXPECT_EQ("hello", pop(r));
+    EXPECT_EQ("", pop(r));
+    EXPECT_EQ("world!", pop(r));
+    EXPECT_TRUE(r.empty());
+}
+
+TEST(record_ring, reserve_and_commit)
+{
+    auto r = stdex::record_ring<64>();
+    auto span = r.reserve(32);
+    EXPECT_EQ(32u, span.size());
+    auto n = std::snprintf(span.data(), span.size(), "value=%d", 42);
+    r.commit(static_cast<std::size_t>(n));
+
+    EXPECT_EQ(1u, r.size());
+    EXPECT_EQ(12u, r.bytes_used());
+    EXPECT_EQ("value=42", pop(r));
+}
+
+TEST(record_ring, wraps_with_padding)
+{
+    auto r = stdex::record_ring<48>();
+    push(r, "aaaaaaaa"); // 12 bytes
+    push(r, "bbbbbbbb"); // 12 bytes
+    push(r, "cccccccc"); // 12 bytes
+    EXPECT_EQ("aaaaaaaa", pop(r));
+    EXPECT_EQ("bbbbbbbb", pop(r));
+
+    // 12 bytes are left at the end, so the record starts at the beginning
+    push(r, "dddddddddddd"); // 16 bytes
+    EXPECT_EQ(2u, r.size());
+    EXPECT_EQ(40u, r.bytes_used());
+    EXPECT_EQ(0u, r.dropped());
+    EXPECT_EQ("cccccccc", pop(r));
+    EXPECT_EQ("dddddddddddd", pop(r));
+    EXPECT_TRUE(r.empty());
+}
+
+TEST(record_ring, evicts_whole_records)
+{
+    auto r = stdex::record_ring<32>();
+    push(r, "1111");
+    push(r, "2222");
+    push(r, "3333");
+    push(r, "4444");
+    EXPECT_EQ(4u, r.size());
+    EXPECT_EQ(32u, r.bytes_used());
+
+    push(r, "55555555");
+    EXPECT_EQ(2u, r.dropped());
+    EXPECT_EQ(3u, r.size());
+    EXPECT_EQ("3333", pop(r));
+    EXPECT_EQ("4444", pop(r));
+    EXPECT_EQ("55555555", pop(r));
+}
+
+TEST(record_ring, max_record)
+{
+    auto r = stdex::record_ring<32>();
+    push(r, "abc");
+    auto span = r.reserve(r.max_record_size());
+    std::memset(span.data(), 'x', span.size());
+    r.commit();
+    EXPECT_EQ(1u, r.dropped());
+    EXPECT_EQ(std::string(28, 'x'), pop(r));
+
+    EXPECT_THROW(r.reserve(29), std::length_error);
+}
+
+TEST(record_ring, random_records)
+{
+    auto r    = stdex::record_ring<256>();
+    auto ref  = std::deque<std::string>();
+    auto gen  = std::mt19937(3);
+    auto seen = 0u;
+    for (auto i = 0; i < 5000; i++)
+    {
+        if (gen() % 3 != 0)
+        {
+            auto text = std::string(gen() % 40, static_cast<char>('a' + i % 26));
+            push(r, text);
+            ref.push_back(text);
+            while (ref.size() > r.size())
+            {
+                ref.pop_front();
+            }
+        }
+        else if (!r.empty())
+        {
+            ASSERT_EQ(ref.front(), pop(r));
+            ref.pop_front();
+            seen++;
+        }
+        ASSERT_LE(r.bytes_used(), r.capacity());
+    }
+    EXPECT_LT(0u, seen);
+    EXPECT_LT(0u, r.dropped());
+}
@@ -9,6 +9,18 @@
 
 #include <gtest/gtest.h>
 #include <tuple>
+#include <string>
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <list>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <deque>
+#include <random>
+#include <numeric>
 #include <stdex/ring.h>
 #include <stdex/algorithm.h>
 
@@ -441,4 +453,1017 @@ TEST(ring, criterator2)
         iter++;
         i--;
     }
-}
\ No newline at end of file
+}
+
+TEST(ring, inline_default_contructor)
+{
+    auto r = stdex::ring<int, 10, stdex::inline_storage>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+}
+
+TEST(ring, inline_roll_over_forward)
+{
+    auto r = stdex::ring<int, 10, stdex::inline_storage>();
+    for (unsigned i = 0u; i < r.capacity() * 2 + 3; i++)
+    {
+        r.push_back(i);
+    }
+    EXPECT_EQ(10u, r.size());
+    EXPECT_EQ(13u, r.front());
+    EXPECT_EQ(22u, r.back());
+
+    auto ref = 13u;
+    for (const auto& v : r)
+    {
+        EXPECT_EQ(ref, v);
+        ref++;
+    }
+    EXPECT_EQ(23u, ref);
+}
+
+TEST(ring, inline_roll_over_backward)
+{
+    auto r = stdex::ring<int, 10, stdex::inline_storage>();
+    for (unsigned i = 0u; i < r.capacity() * 2; i++)
+    {
+        r.push_front(i);
+    }
+    EXPECT_EQ(10u, r.size());
+    EXPECT_EQ(19u, r.front());
+    EXPECT_EQ(10u, r.back());
+
+    auto ref = 19u;
+    for (const auto& v : r)
+    {
+        EXPECT_EQ(ref, v);
+        ref--;
+    }
+    EXPECT_EQ(9u, ref);
+}
+
+TEST(ring, inline_roll_over_power_of_two)
+{
+    auto r = stdex::ring<int, 8, stdex::inline_storage>();
+    for (unsigned i = 0u; i < 21u; i++)
+    {
+        r.push_back(i);
+    }
+    r.push_front(99);
+
+    auto ref = std::vector<int>{99, 13, 14, 15, 16, 17, 18, 19};
+    EXPECT_TRUE(stdex::equals(begin(r), end(r), begin(ref), end(ref)));
+    EXPECT_TRUE(stdex::equals(r.rbegin(), r.rend(), ref.rbegin(), ref.rend()));
+}
+
+TEST(ring, inline_init_args_to_many)
+{
+    auto rng = stdex::ring<int, 10, stdex::inline_storage>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+    auto ref = std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, inline_pop)
+{
+    auto rng = stdex::ring<int, 4, stdex::inline_storage>{0, 1, 2, 3};
+    rng.push_back(4);
+    rng.pop_front();
+    rng.pop_back();
+
+    auto ref = std::vector<int>{2, 3};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, inline_insert)
+{
+    auto rng = stdex::ring<int, 10, stdex::inline_storage>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    rng.push_back(10);
+
+    auto i = rng.begin() + 5;
+    rng.insert(i, 99);
+
+    auto ref = std::vector<int>{1, 2, 3, 4, 5, 99, 6, 7, 8, 9};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, inline_insert_end)
+{
+    auto rng = stdex::ring<int, 10, stdex::inline_storage>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    rng.insert(rng.end(), 99);
+
+    auto ref = std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, inline_strings)
+{
+    auto r = stdex::ring<std::string, 3, stdex::inline_storage>();
+    r.push_back("one");
+    r.push_back("two");
+    r.emplace_back(3, 'x');
+    r.emplace_back("four");
+
+    auto c = r;
+    r.clear();
+
+    auto ref = std::vector<std::string>{"two", "xxx", "four"};
+    EXPECT_TRUE(r.empty());
+    EXPECT_TRUE(stdex::equals(begin(c), end(c), begin(ref), end(ref)));
+}
+
+TEST(ring, inline_swap)
+{
+    auto a = stdex::ring<int, 10, stdex::inline_storage>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    auto b = stdex::ring<int, 10, stdex::inline_storage>{};
+    swap(a, b);
+
+    EXPECT_EQ(0u, a.size());
+
+    EXPECT_EQ(10u, b.size());
+    EXPECT_EQ(0u, b.front());
+    EXPECT_EQ(9u, b.back());
+}
+
+TEST(ring, append)
+{
+    auto rng = stdex::ring<int, 5>{0, 1, 2};
+    auto values = std::vector<int>{3, 4, 5, 6};
+    rng.append(begin(values), end(values));
+
+    auto ref = std::vector<int>{2, 3, 4, 5, 6};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, append_to_large)
+{
+    auto rng = stdex::ring<int, 5>{0, 1, 2};
+    auto values = std::vector<int>{3, 4, 5, 6, 7, 8, 9, 10};
+    rng.append(stdex::array_view<int>(values));
+
+    auto ref = std::vector<int>{6, 7, 8, 9, 10};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, prepend)
+{
+    auto rng = stdex::ring<int, 5>{0, 1, 2};
+    auto values = std::list<int>{3, 4, 5};
+    rng.prepend(begin(values), end(values));
+
+    auto ref = std::vector<int>{5, 4, 3, 0, 1};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, prepend_to_large)
+{
+    auto rng = stdex::ring<int, 5>{0, 1, 2};
+    auto values = std::vector<int>{3, 4, 5, 6, 7, 8, 9, 10};
+    rng.prepend(stdex::array_view<int>(values));
+
+    auto ref = std::vector<int>{10, 9, 8, 7, 6};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, append_vector_backend)
+{
+    auto rng = stdex::ring<int, 5, std::vector<int>>{0, 1, 2, 3};
+    auto values = std::vector<int>{4, 5};
+    rng.append(begin(values), end(values));
+
+    auto ref = std::vector<int>{1, 2, 3, 4, 5};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, inline_append)
+{
+    auto rng = stdex::ring<int, 5, stdex::inline_storage>{0, 1, 2};
+    auto values = std::vector<int>{3, 4, 5, 6, 7, 8, 9, 10};
+    rng.append(begin(values), begin(values) + 3);
+
+    auto ref1 = std::vector<int>{1, 2, 3, 4, 5};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref1), end(ref1)));
+
+    rng.append(stdex::array_view<int>(values));
+
+    auto ref2 = std::vector<int>{6, 7, 8, 9, 10};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref2), end(ref2)));
+}
+
+TEST(ring, inline_prepend)
+{
+    auto rng = stdex::ring<int, 5, stdex::inline_storage>{0, 1, 2};
+    auto values = std::vector<int>{3, 4, 5};
+    rng.prepend(stdex::array_view<int>(values));
+
+    auto ref = std::vector<int>{5, 4, 3, 0, 1};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, segments_vector_backend)
+{
+    auto rng = stdex::ring<int, 5, std::vector<int>>{0, 1, 2, 3, 4};
+    auto [a, b] = rng.segments();
+
+    auto ref = std::vector<int>{0, 1, 2, 3, 4};
+    EXPECT_TRUE(stdex::equals(begin(a), end(a), begin(ref), end(ref)));
+    EXPECT_TRUE(b.empty());
+}
+
+TEST(ring, visit_segments_deque_backend)
+{
+    auto rng = stdex::ring<int, 5000>();
+    for (auto i = 0; i < 6000; i++)
+    {
+        rng.push_back(i);
+    }
+    EXPECT_FALSE(stdex::is_contiguous_container_v<std::deque<int>>);
+
+    auto values = std::vector<int>();
+    auto runs   = 0;
+    rng.visit_segments([&] (stdex::array_view<int> seg) {
+        values.insert(values.end(), seg.begin(), seg.end());
+        runs++;
+    });
+    EXPECT_EQ(std::vector<int>(rng.begin(), rng.end()), values);
+    EXPECT_LT(1, runs);
+    EXPECT_GE(5000u / stdex::container_block_size_v<std::deque<int>> + 2, static_cast<unsigned>(runs));
+    EXPECT_EQ(5000u, rng.size());
+
+    auto inl = stdex::ring<int, 4, stdex::inline_storage>();
+    for (auto i = 0; i < 6; i++)
+    {
+        inl.push_back(i);
+    }
+    values.clear();
+    inl.visit_segments([&] (stdex::array_view<int> seg) { values.insert(values.end(), seg.begin(), seg.end()); });
+    EXPECT_EQ(std::vector<int>({2, 3, 4, 5}), values);
+}
+
+TEST(ring, inline_segments)
+{
+    auto rng = stdex::ring<int, 5, stdex::inline_storage>{0, 1, 2};
+    auto [a1, b1] = rng.segments();
+    EXPECT_EQ(3u, a1.size());
+    EXPECT_TRUE(b1.empty());
+
+    auto values = std::vector<int>{3, 4, 5, 6};
+    rng.append(begin(values), end(values));
+    auto [a2, b2] = rng.segments();
+
+    auto ref_a = std::vector<int>{2, 3, 4};
+    auto ref_b = std::vector<int>{5, 6};
+    EXPECT_TRUE(stdex::equals(begin(a2), end(a2), begin(ref_a), end(ref_a)));
+    EXPECT_TRUE(stdex::equals(begin(b2), end(b2), begin(ref_b), end(ref_b)));
+}
+
+TEST(ring, inline_free_segments)
+{
+    auto rng = stdex::ring<int, 5, stdex::inline_storage>{0, 1, 2, 3};
+    rng.pop_front();
+    rng.pop_front();
+
+    auto [a, b] = rng.free_segments();
+    EXPECT_EQ(1u, a.size());
+    EXPECT_EQ(2u, b.size());
+
+    a[0] = 4;
+    b[0] = 5;
+    rng.commit(2);
+
+    auto ref = std::vector<int>{2, 3, 4, 5};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+
+    auto [c, d] = rng.free_segments();
+    EXPECT_EQ(1u, c.size());
+    EXPECT_TRUE(d.empty());
+}
+
+TEST(ring, fill_segments_deque_backend)
+{
+    auto rng = stdex::ring<int, 3000>();
+    for (auto i = 0; i < 1000; i++)
+    {
+        rng.push_back(i);
+    }
+
+    // write 1500 elements, the run that reaches them ends the fill
+    auto next = 1000;
+    auto n = rng.fill_segments([&] (stdex::array_span<int> run) {
+        auto count = std::min(run.size(), static_cast<std::size_t>(2500 - next));
+        for (auto i = 0u; i < count; i++)
+        {
+            run[i] = next++;
+        }
+        return count;
+    });
+    EXPECT_EQ(1500u, n);
+    auto ref = std::vector<int>(2500);
+    std::iota(ref.begin(), ref.end(), 0);
+    EXPECT_EQ(ref, std::vector<int>(rng.begin(), rng.end()));
+    EXPECT_EQ(2500u, rng.next_sequence());
+
+    // the remaining room fills the ring, a full ring takes nothing
+    n = rng.fill_segments([] (stdex::array_span<int> run) {
+        std::fill(run.begin(), run.end(), -1);
+        return run.size();
+    });
+    EXPECT_EQ(500u, n);
+    EXPECT_EQ(3000u, rng.size());
+    EXPECT_EQ(0u, rng.fill_segments([] (stdex::array_span<int> run) { return run.size(); }));
+}
+
+TEST(ring, inline_fill_segments)
+{
+    auto rng = stdex::ring<int, 5, stdex::inline_storage>{0, 1, 2, 3};
+    rng.pop_front();
+    rng.pop_front();
+
+    auto calls = 0;
+    auto n = rng.fill_segments([&] (stdex::array_span<int> seg) {
+        calls++;
+        std::iota(seg.begin(), seg.end(), calls == 1 ? 4 : 5);
+        return seg.size();
+    });
+    EXPECT_EQ(3u, n);
+    EXPECT_EQ(2, calls);
+
+    auto ref = std::vector<int>{2, 3, 4, 5, 6};
+    EXPECT_TRUE(stdex::equals(begin(rng), end(rng), begin(ref), end(ref)));
+}
+
+TEST(ring, sequence)
+{
+    auto rng = stdex::ring<int, 4>();
+    EXPECT_EQ(0u, rng.oldest_sequence());
+    EXPECT_EQ(0u, rng.next_sequence());
+    EXPECT_EQ(nullptr, rng.at_sequence(0));
+
+    for (auto i = 0; i < 10; i++)
+    {
+        rng.push_back(i * 10);
+    }
+    EXPECT_EQ(6u, rng.oldest_sequence());
+    EXPECT_EQ(10u, rng.next_sequence());
+    EXPECT_EQ(nullptr, rng.at_sequence(5));
+    EXPECT_EQ(60, *rng.at_sequence(6));
+    EXPECT_EQ(90, *rng.at_sequence(9));
+    EXPECT_EQ(nullptr, rng.at_sequence(10));
+
+    rng.pop_front();
+    EXPECT_EQ(7u, rng.oldest_sequence());
+    EXPECT_EQ(nullptr, rng.at_sequence(6));
+
+    rng.clear();
+    EXPECT_EQ(10u, rng.oldest_sequence());
+    EXPECT_EQ(10u, rng.next_sequence());
+}
+
+TEST(ring, sequence_resume)
+{
+    auto rng = stdex::ring<int, 4>();
+    auto values = std::vector<int>{0, 1, 2, 3, 4, 5};
+    rng.append(begin(values), end(values));
+
+    // a reader that stopped at 1 missed 2 elements and resumes at 2
+    auto pos = std::uint64_t(1);
+    EXPECT_EQ(nullptr, rng.at_sequence(pos));
+    EXPECT_EQ(1u, rng.oldest_sequence() - pos);
+
+    pos = rng.oldest_sequence();
+    auto read = std::vector<int>();
+    while (auto p = rng.at_sequence(pos))
+    {
+        read.push_back(*p);
+        pos++;
+    }
+    auto ref = std::vector<int>{2, 3, 4, 5};
+    EXPECT_EQ(ref, read);
+}
+
+TEST(ring, inline_sequence)
+{
+    auto rng = stdex::ring<int, 4, stdex::inline_storage>();
+    for (auto i = 0; i < 10; i++)
+    {
+        rng.push_back(i * 10);
+    }
+    EXPECT_EQ(6u, rng.oldest_sequence());
+    EXPECT_EQ(10u, rng.next_sequence());
+    EXPECT_EQ(nullptr, rng.at_sequence(5));
+    EXPECT_EQ(70, *rng.at_sequence(7));
+
+    auto copy = rng;
+    EXPECT_EQ(6u, copy.oldest_sequence());
+
+    rng.pop_front();
+    rng.push_back(100);
+    EXPECT_EQ(7u, rng.oldest_sequence());
+    EXPECT_EQ(100, *rng.at_sequence(10));
+}
+
+TEST(ring, inline_append_sequence)
+{
+    auto values = std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+    auto rng = stdex::ring<int, 4, stdex::inline_storage>();
+    rng.append(begin(values), end(values));
+    EXPECT_EQ(6u, rng.oldest_sequence());
+    EXPECT_EQ(10u, rng.next_sequence());
+    EXPECT_EQ(6, *rng.at_sequence(6));
+
+    auto ref = stdex::ring<int, 4>();
+    ref.append(begin(values), end(values));
+    EXPECT_EQ(ref.oldest_sequence(), rng.oldest_sequence());
+    EXPECT_EQ(ref.next_sequence(), rng.next_sequence());
+}
+
+namespace
+{
+    template <typename Ring>
+    void check_unsequenced(Ring& rng, std::uint64_t next)
+    {
+        EXPECT_FALSE(rng.sequenced());
+        EXPECT_EQ(next, rng.oldest_sequence());
+        EXPECT_EQ(next, rng.next_sequence());
+        for (auto n = std::uint64_t(0); n < next + rng.size(); n++)
+        {
+            EXPECT_EQ(nullptr, rng.at_sequence(n));
+        }
+    }
+
+    template <typename Ring>
+    void end_numbering(Ring& rng)
+    {
+        rng.push_back(10);
+        rng.push_back(20);
+        rng.push_back(30);
+        rng.pop_front();
+        EXPECT_TRUE(rng.sequenced());
+        EXPECT_EQ(20, *rng.at_sequence(1));
+
+        // a reader holding 1 is not sent through renumbered elements and
+        // the unnumbered elements take no numbers
+        rng.push_front(5);
+        check_unsequenced(rng, 3u);
+        EXPECT_EQ(std::vector<int>({5, 20, 30}), std::vector<int>(rng.begin(), rng.end()));
+
+        // pushing to the back does not number the elements again
+        rng.push_back(40);
+        check_unsequenced(rng, 4u);
+
+        // clear numbers the next elements after everything handed out
+        rng.clear();
+        EXPECT_TRUE(rng.sequenced());
+        EXPECT_EQ(4u, rng.oldest_sequence());
+        rng.push_back(50);
+        EXPECT_EQ(50, *rng.at_sequence(4));
+
+        rng.pop_back();
+        check_unsequenced(rng, 5u);
+        rng.clear();
+
+        rng.push_back(60);
+        rng.insert(std::next(rng.cbegin()), 70);
+        check_unsequenced(rng, 6u);
+        rng.clear();
+
+        rng.push_back(80);
+        rng.emplace(rng.cbegin(), 90);
+        check_unsequenced(rng, 7u);
+        rng.clear();
+
+        auto values = std::vector<int>{1, 2};
+        rng.prepend(values.begin(), values.end());
+        check_unsequenced(rng, 7u);
+        EXPECT_EQ(std::vector<int>({2, 1}), std::vector<int>(rng.begin(), rng.end()));
+        rng.clear();
+
+        // an empty prepend stores nothing and keeps the numbering
+        rng.push_back(100);
+        rng.prepend(values.end(), values.end());
+        EXPECT_TRUE(rng.sequenced());
+        EXPECT_EQ(100, *rng.at_sequence(7));
+    }
+}
+
+TEST(ring, end_numbering)
+{
+    auto deq = stdex::ring<int, 4>();
+    end_numbering(deq);
+    auto lst = stdex::ring<int, 4, std::list<int>, 2>();
+    end_numbering(lst);
+    auto inl = stdex::ring<int, 4, stdex::inline_storage>();
+    end_numbering(inl);
+}
+
+TEST(ring, unsequenced_copy)
+{
+    auto rng = stdex::ring<int, 4, stdex::inline_storage>{10, 20, 30};
+    rng.push_front(5);
+    auto copy = rng;
+    EXPECT_FALSE(copy.sequenced());
+
+    auto moved = std::move(copy);
+    EXPECT_FALSE(moved.sequenced());
+    EXPECT_EQ(nullptr, moved.at_sequence(3));
+}
+
+namespace
+{
+    template <typename Ring>
+    void insert_past_end(Ring& rng)
+    {
+        for (auto i = 0; i < 25; i++)
+        {
+            rng.push_back(i);
+        }
+        EXPECT_EQ(rng.end(), rng.insert(rng.cend(), 100));
+        EXPECT_EQ(rng.end(), rng.emplace(rng.cend(), 101));
+        auto extra = std::vector<int>{102, 103};
+        EXPECT_EQ(rng.end(), rng.insert(rng.cend(), extra.begin(), extra.end()));
+        EXPECT_EQ(std::next(rng.begin()), rng.insert(std::next(rng.cbegin()), extra.end(), extra.end()));
+
+        EXPECT_EQ(20u, rng.oldest_sequence());
+        EXPECT_EQ(25u, rng.next_sequence());
+        EXPECT_EQ(std::vector<int>({20, 21, 22, 23, 24}), std::vector<int>(rng.begin(), rng.end()));
+    }
+}
+
+TEST(ring, insert_past_end_sequence)
+{
+    auto deq = stdex::ring<int, 5>();
+    insert_past_end(deq);
+    auto vec = stdex::ring<int, 5, std::vector<int>>();
+    insert_past_end(vec);
+    auto lst = stdex::ring<int, 5, std::list<int>, 3>();
+    insert_past_end(lst);
+    auto inl = stdex::ring<int, 5, stdex::inline_storage>();
+    insert_past_end(inl);
+}
+
+TEST(ring, pop_front_n)
+{
+    auto rng = stdex::ring<int, 8>();
+    for (auto i = 0; i < 10; i++)
+    {
+        rng.push_back(i);
+    }
+
+    auto out = std::vector<int>();
+    rng.pop_front_n(3, std::back_inserter(out));
+    auto ref = std::vector<int>{2, 3, 4};
+    EXPECT_EQ(ref, out);
+    EXPECT_EQ(5u, rng.size());
+    EXPECT_EQ(5, rng.front());
+    EXPECT_EQ(5u, rng.oldest_sequence());
+
+    // asking for more than is there moves out the rest
+    rng.pop_front_n(100, std::back_inserter(out));
+    ref = std::vector<int>{2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(ref, out);
+    EXPECT_TRUE(rng.empty());
+}
+
+TEST(ring, drain_into)
+{
+    auto rng = stdex::ring<std::string, 4>();
+    rng.push_back("one");
+    rng.push_back("two");
+    rng.push_back("three");
+
+    auto out = std::vector<std::string>{"zero"};
+    EXPECT_EQ(3u, rng.drain_into(out));
+    auto ref = std::vector<std::string>{"zero", "one", "two", "three"};
+    EXPECT_EQ(ref, out);
+    EXPECT_TRUE(rng.empty());
+    EXPECT_EQ(3u, rng.oldest_sequence());
+}
+
+TEST(ring, consume_vector_backend)
+{
+    auto rng = stdex::ring<int, 4, std::vector<int>>();
+    for (auto i = 0; i < 6; i++)
+    {
+        rng.push_back(i);
+    }
+
+    auto calls = 0u;
+    auto out   = std::vector<int>();
+    auto n = rng.consume(3, [&] (const stdex::array_view<int>& values) {
+        calls++;
+        out.insert(out.end(), values.begin(), values.end());
+    });
+    EXPECT_EQ(3u, n);
+    EXPECT_EQ(1u, calls);
+    auto ref = std::vector<int>{2, 3, 4};
+    EXPECT_EQ(ref, out);
+    EXPECT_EQ(1u, rng.size());
+    EXPECT_EQ(5, rng.front());
+}
+
+TEST(ring, consume_deque_backend)
+{
+    auto rng = stdex::ring<int, 2000>();
+    for (auto i = 0; i < 2500; i++)
+    {
+        rng.push_back(i);
+    }
+
+    auto out = std::vector<int>();
+    auto n = rng.consume(1500, [&] (const stdex::array_view<int>& values) {
+        EXPECT_FALSE(values.empty());
+        out.insert(out.end(), values.begin(), values.end());
+    });
+    EXPECT_EQ(1500u, n);
+    ASSERT_EQ(1500u, out.size());
+    for (auto i = 0u; i < out.size(); i++)
+    {
+        EXPECT_EQ(static_cast<int>(i) + 500, out[i]);
+    }
+    EXPECT_EQ(500u, rng.size());
+    EXPECT_EQ(2000, rng.front());
+}
+
+TEST(ring, inline_pop_front_n)
+{
+    auto rng = stdex::ring<std::string, 4, stdex::inline_storage>();
+    for (auto i = 0; i < 6; i++)
+    {
+        rng.push_back(std::to_string(i));
+    }
+
+    auto out = std::vector<std::string>();
+    rng.pop_front_n(3, std::back_inserter(out));
+    auto ref = std::vector<std::string>{"2", "3", "4"};
+    EXPECT_EQ(ref, out);
+    EXPECT_EQ(1u, rng.size());
+    EXPECT_EQ("5", rng.front());
+    EXPECT_EQ(5u, rng.oldest_sequence());
+
+    rng.push_back("6");
+    out.clear();
+    EXPECT_EQ(2u, rng.drain_into(out));
+    ref = std::vector<std::string>{"5", "6"};
+    EXPECT_EQ(ref, out);
+    EXPECT_TRUE(rng.empty());
+}
+
+TEST(ring, inline_consume)
+{
+    auto rng = stdex::ring<int, 4, stdex::inline_storage>();
+    for (auto i = 0; i < 7; i++)
+    {
+        rng.push_back(i);
+    }
+
+    // the contents wrap around, so there are two segments
+    auto segs = std::vector<std::vector<int>>();
+    auto n = rng.consume(4, [&] (const stdex::array_view<int>& values) {
+        segs.emplace_back(values.begin(), values.end());
+    });
+    EXPECT_EQ(4u, n);
+    auto ref = std::vector<std::vector<int>>{{3}, {4, 5, 6}};
+    EXPECT_EQ(ref, segs);
+    EXPECT_TRUE(rng.empty());
+    EXPECT_EQ(7u, rng.oldest_sequence());
+}
+
+TEST(ring, range_constructor_uses_allocator)
+{
+    auto buffer   = std::array<std::byte, 4096>();
+    auto resource = std::pmr::monotonic_buffer_resource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+    auto values   = std::vector<int>{1, 2, 3, 4, 5, 6};
+
+    auto rng = stdex::pmr::ring<int, 4>(values.begin(), values.end(), &resource);
+    EXPECT_EQ(&resource, rng.get_allocator().resource());
+    auto ref = std::vector<int>{1, 2, 3, 4};
+    EXPECT_EQ(ref, std::vector<int>(rng.begin(), rng.end()));
+
+    auto ilst = stdex::pmr::ring<int, 4>({7, 8, 9}, &resource);
+    EXPECT_EQ(&resource, ilst.get_allocator().resource());
+}
+
+TEST(ring, copy_with_allocator)
+{
+    auto resource = std::pmr::unsynchronized_pool_resource();
+    auto rng = stdex::pmr::ring<int, 4>();
+    for (auto i = 0; i < 6; i++)
+    {
+        rng.push_back(i);
+    }
+
+    auto copy = stdex::pmr::ring<int, 4>(rng, &resource);
+    EXPECT_EQ(&resource, copy.get_allocator().resource());
+    EXPECT_EQ(2u, copy.oldest_sequence());
+    EXPECT_EQ(2, copy.front());
+}
+
+TEST(ring, allocator_propagates_to_nested_rings)
+{
+    auto resource = std::pmr::unsynchronized_pool_resource();
+    auto rings = std::pmr::vector<stdex::pmr::ring<int, 4>>(&resource);
+    rings.emplace_back();
+    rings.resize(3);
+    for (const auto& r : rings)
+    {
+        EXPECT_EQ(&resource, r.get_allocator().resource());
+    }
+}
+
+namespace
+{
+    //! Counts how often instances are copied and moved.
+    struct counted
+    {
+        static inline int copies = 0;
+        static inline int moves  = 0;
+
+        int value = 0;
+
+        counted(int v) noexcept
+        : value(v) {}
+
+        counted(int a, int b) noexcept
+        : value(a + b) {}
+
+        counted(const counted& other) noexcept
+        : value(other.value)
+        {
+            copies++;
+        }
+
+        counted(counted&& other) noexcept
+        : value(other.value)
+        {
+            moves++;
+        }
+
+        counted& operator = (const counted& other) noexcept
+        {
+            value = other.value;
+            copies++;
+            return *this;
+        }
+
+        counted& operator = (counted&& other) noexcept
+        {
+            value = other.value;
+            moves++;
+            return *this;
+        }
+
+        static void reset() noexcept
+        {
+            copies = 0;
+            moves  = 0;
+        }
+    };
+
+    template <typename Ring>
+    void push_rvalues(Ring& rng)
+    {
+        for (auto i = 0; i < 6; i++)
+        {
+            rng.push_back(counted(i));
+            rng.emplace_back(i, i);
+            if constexpr (!std::is_same_v<typename Ring::container_type, std::vector<counted>>)
+            {
+                rng.push_front(counted(i));
+                rng.emplace_front(i, 1);
+            }
+            rng.insert(rng.cbegin() + 1, counted(i));
+            rng.emplace(rng.cbegin() + 2, i, 2);
+        }
+    }
+}
+
+TEST(ring, rvalues_are_not_copied)
+{
+    auto deq = stdex::ring<counted, 4>();
+    auto vec = stdex::ring<counted, 4, std::vector<counted>>();
+    auto inl = stdex::ring<counted, 4, stdex::inline_storage>();
+
+    counted::reset();
+    push_rvalues(deq);
+    push_rvalues(vec);
+    push_rvalues(inl);
+    EXPECT_EQ(0, counted::copies);
+    EXPECT_LT(0, counted::moves);
+
+    auto values = std::vector<int>();
+    for (const auto& c : deq)
+    {
+        values.push_back(c.value);
+    }
+    auto ref = std::vector<int>{6, 5, 7, 5};
+    EXPECT_EQ(ref, values);
+}
+
+TEST(ring, move_only)
+{
+    auto rng = stdex::ring<std::unique_ptr<int>, 3>();
+    rng.push_back(std::make_unique<int>(1));
+    rng.emplace_back(new int(2));
+    rng.push_front(std::make_unique<int>(0));
+    rng.push_back(std::make_unique<int>(3));
+    rng.insert(rng.cbegin(), std::make_unique<int>(4));
+    EXPECT_EQ(3u, rng.size());
+    EXPECT_EQ(4, *rng.front());
+    EXPECT_EQ(2, *rng.back());
+
+    auto moved = std::move(rng);
+    EXPECT_EQ(3u, moved.size());
+    auto inl = stdex::ring<std::unique_ptr<int>, 2, stdex::inline_storage>();
+    inl.push_back(std::move(moved.front()));
+    inl.emplace_back(new int(5));
+    inl.emplace_back(new int(6));
+    EXPECT_EQ(5, *inl.front());
+}
+
+TEST(ring, emplace_multiple_arguments)
+{
+    auto rng = stdex::ring<std::pair<std::string, int>, 3>();
+    rng.emplace_back("b", 2);
+    rng.emplace_front("a", 1);
+    rng.emplace(rng.cbegin() + 1, "c", 3);
+    EXPECT_EQ("a", rng.front().first);
+    EXPECT_EQ(3, (rng.begin() + 1)->second);
+    EXPECT_EQ("b", rng.back().first);
+}
+
+// Run with --gtest_also_run_disabled_tests to compare pushing 4 KiB
+// payloads by copy and by move.
+TEST(ring, DISABLED_benchmark_payload_4k)
+{
+    using payload = std::vector<char>;
+    using clock   = std::chrono::steady_clock;
+    const auto count = 200000;
+
+    auto measure = [&] (auto push) {
+        auto rng   = stdex::ring<payload, 64>();
+        auto start = clock::now();
+        for (auto i = 0; i < count; i++)
+        {
+            push(rng, payload(4096, static_cast<char>(i)));
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+        return elapsed.count() / count;
+    };
+
+    auto copy = measure([] (auto& rng, const payload& p) { rng.push_back(p); });
+    auto move = measure([] (auto& rng, payload&& p) { rng.push_back(std::move(p)); });
+    RecordProperty("copy_ns", static_cast<int>(copy));
+    RecordProperty("move_ns", static_cast<int>(move));
+    EXPECT_LT(move, copy);
+}
+
+TEST(ring, slack_hides_stale_elements)
+{
+    auto rng = stdex::ring<int, 4, std::vector<int>, 4>();
+    EXPECT_EQ(4u, rng.slack());
+    for (auto i = 0; i < 7; i++)
+    {
+        rng.push_back(i);
+    }
+
+    EXPECT_EQ(4u, rng.size());
+    EXPECT_EQ(3, rng.front());
+    EXPECT_EQ(6, rng.back());
+    EXPECT_EQ(3, *rng.data());
+    EXPECT_EQ(3u, rng.oldest_sequence());
+    EXPECT_EQ(nullptr, rng.at_sequence(2));
+    EXPECT_EQ(4, *rng.at_sequence(4));
+
+    auto ref = std::vector<int>{3, 4, 5, 6};
+    EXPECT_EQ(ref, std::vector<int>(rng.begin(), rng.end()));
+    EXPECT_EQ(ref, std::vector<int>(rng.segments()[0].begin(), rng.segments()[0].end()));
+    auto rref = std::vector<int>{6, 5, 4, 3};
+    EXPECT_EQ(rref, std::vector<int>(rng.rbegin(), rng.rend()));
+
+    rng.pop_back();
+    rng.push_back(7);
+    EXPECT_EQ(ref.size(), rng.size());
+    EXPECT_EQ(3, rng.front());
+}
+
+namespace
+{
+    //! Apply the same random operations to a ring and a reference ring.
+    template <bool FrontOps, typename Ring, typename Ref>
+    void compare_random_operations(Ring& rng, Ref& ref)
+    {
+        auto gen = std::mt19937(11);
+        for (auto i = 0; i < 2000; i++)
+        {
+            auto op = gen() % 10;
+            if (op < 5)
+            {
+                rng.push_back(i);
+                ref.push_back(i);
+            }
+            else if (op == 5)
+            {
+                if constexpr (FrontOps)
+                {
+                    rng.push_front(i);
+                    ref.push_front(i);
+                }
+            }
+            else if (op == 6 && !ref.empty())
+            {
+                rng.pop_front();
+                ref.pop_front();
+            }
+            else if (op == 7 && !ref.empty())
+            {
+                rng.pop_back();
+                ref.pop_back();
+            }
+            else if (op == 8 && !ref.empty())
+            {
+                auto pos = gen() % ref.size();
+                rng.insert(rng.cbegin() + pos, i);
+                ref.insert(ref.cbegin() + pos, i);
+            }
+            else if (op == 9)
+            {
+                auto out  = std::vector<int>();
+                auto rout = std::vector<int>();
+                rng.pop_front_n(2, std::back_inserter(out));
+                ref.pop_front_n(2, std::back_inserter(rout));
+                ASSERT_EQ(rout, out);
+            }
+
+            ASSERT_EQ(ref.size(), rng.size());
+            ASSERT_EQ(ref.sequenced(), rng.sequenced());
+            ASSERT_EQ(ref.oldest_sequence(), rng.oldest_sequence());
+            ASSERT_EQ(ref.next_sequence(), rng.next_sequence());
+            ASSERT_TRUE(std::equal(ref.begin(), ref.end(), rng.begin(), rng.end()));
+        }
+    }
+}
+
+TEST(ring, slack_matches_eager_ring)
+{
+    auto ref = stdex::ring<int, 5>();
+    auto deq = stdex::ring<int, 5, std::deque<int>, 3>();
+    compare_random_operations<true>(deq, ref);
+
+    auto vref = stdex::ring<int, 5, std::vector<int>>();
+    auto vec  = stdex::ring<int, 5, std::vector<int>, 7>();
+    compare_random_operations<false>(vec, vref);
+}
+
+TEST(ring, slack_list_backend)
+{
+    auto rng = stdex::ring<int, 3, std::list<int>, 3>();
+    for (auto i = 0; i < 10; i++)
+    {
+        rng.push_back(i);
+    }
+    auto ref = std::vector<int>{7, 8, 9};
+    EXPECT_EQ(ref, std::vector<int>(rng.begin(), rng.end()));
+
+    rng.push_front(6);
+    ref = std::vector<int>{6, 7, 8};
+    EXPECT_EQ(ref, std::vector<int>(rng.begin(), rng.end()));
+}
+
+namespace
+{
+    template <typename Ring>
+    long long nanoseconds_per_push(int count)
+    {
+        using clock = std::chrono::steady_clock;
+        auto rng   = Ring();
+        auto start = clock::now();
+        for (auto i = 0; i < count; i++)
+        {
+            rng.push_back(i);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+        return elapsed.count() * 1000 / count;
+    }
+
+    template <typename Container>
+    void benchmark_slack(const char* name)
+    {
+        const auto count = 2000000;
+        auto eager = nanoseconds_per_push<stdex::ring<int, 1024, Container>>(count);
+        auto lazy  = nanoseconds_per_push<stdex::ring<int, 1024, Container, 1024>>(count);
+        ::testing::Test::RecordProperty(std::string(name) + "_eager_ps", static_cast<int>(eager));
+        ::testing::Test::RecordProperty(std::string(name) + "_slack_ps", static_cast<int>(lazy));
+    }
+}
+
+// Run with --gtest_also_run_disabled_tests to compare eager pruning and
+// slack on the different backends.
+TEST(ring, DISABLED_benchmark_slack)
+{
+    benchmark_slack<std::deque<int>>("deque");
+    benchmark_slack<std::list<int>>("list");
+    benchmark_slack<std::vector<int>>("vector");
+}
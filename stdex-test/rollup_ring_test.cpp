@@ -0,0 +1,155 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include <stdex/rollup_ring.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point at(clock::duration d)
+    {
+        return clock::time_point(d);
+    }
+}
+
+TEST(rollup_ring, default_contructor)
+{
+    auto r = stdex::rollup_ring<int, stdex::rollup_sum, 60, 24>({1s, 1min});
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(2u, r.tier_count);
+    EXPECT_EQ(clock::duration(1min), r.resolution(1));
+}
+
+TEST(rollup_ring, invalid_resolutions)
+{
+    using ring_t = stdex::rollup_ring<int, stdex::rollup_sum, 60, 24>;
+    EXPECT_THROW(ring_t({1min, 1s}), std::invalid_argument);
+    EXPECT_THROW(ring_t({0s, 1s}), std::invalid_argument);
+}
+
+TEST(rollup_ring, folds_into_bucket)
+{
+    auto r = stdex::rollup_ring<int, stdex::rollup_sum, 10, 10>({1s, 10s});
+    r.push_back(1, at(1000ms));
+    r.push_back(2, at(1500ms));
+    r.push_back(3, at(2100ms));
+
+    const auto& t0 = r.tier<0>();
+    ASSERT_EQ(2u, t0.size());
+    EXPECT_EQ(at(1s), t0.front().time);
+    EXPECT_EQ(3, t0.front().value);
+    EXPECT_EQ(at(2s), t0.back().time);
+    EXPECT_EQ(3, t0.back().value);
+    EXPECT_TRUE(r.tier<1>().empty());
+}
+
+TEST(rollup_ring, evicts_into_coarser_tier)
+{
+    auto r = stdex::rollup_ring<int, stdex::rollup_sum, 5, 3, 2>({1s, 5s, 15s});
+    for (auto i = 0; i < 60; i++)
+    {
+        r.push_back(1, at(i * 1s));
+    }
+
+    // 5 seconds, 3 times 5 seconds, 2 times 15 seconds
+    const auto& t0 = r.tier<0>();
+    const auto& t1 = r.tier<1>();
+    const auto& t2 = r.tier<2>();
+    ASSERT_EQ(5u, t0.size());
+    ASSERT_EQ(3u, t1.size());
+    ASSERT_EQ(2u, t2.size());
+    EXPECT_EQ(at(55s), t0.front().time);
+    EXPECT_EQ(at(40s), t1.front().time);
+    EXPECT_EQ(5, t1.front().value);
+    EXPECT_EQ(at(15s), t2.front().time);
+    EXPECT_EQ(15, t2.front().value);
+    EXPECT_EQ(at(30s), t2.back().time);
+    EXPECT_EQ(10, t2.back().value);
+}
+
+TEST(rollup_ring, query_uses_finest_tier)
+{
+    auto r = stdex::rollup_ring<int, stdex::rollup_sum, 5, 3, 2>({1s, 5s, 15s});
+    for (auto i = 0; i < 60; i++)
+    {
+        r.push_back(1, at(i * 1s));
+    }
+
+    using datapoint = decltype(r)::datapoint;
+    auto points = std::vector<datapoint>();
+
+    // recent data comes from the finest tier
+    r.query(at(56s), at(58s), std::back_inserter(points));
+    ASSERT_EQ(2u, points.size());
+    EXPECT_EQ(at(56s), points[0].time);
+    EXPECT_EQ(clock::duration(1s), points[0].resolution);
+
+    // older data is answered by coarser buckets and nothing is counted twice
+    points.clear();
+    r.query(at(0s), at(60s), std::back_inserter(points));
+    auto total = 0;
+    auto last  = at(0s);
+    for (const auto& p : points)
+    {
+        EXPECT_LE(last, p.time);
+        last   = p.time;
+        total += p.value;
+    }
+    EXPECT_EQ(45, total);
+    EXPECT_EQ(10u, points.size());
+    EXPECT_EQ(clock::duration(15s), points.front().resolution);
+    EXPECT_EQ(clock::duration(1s), points.back().resolution);
+
+    // a range older than the history is empty
+    points.clear();
+    r.query(at(0s), at(15s), std::back_inserter(points));
+    EXPECT_TRUE(points.empty());
+}
+
+TEST(rollup_ring, aggregators)
+{
+    auto mn = stdex::rollup_ring<int, stdex::rollup_min, 2, 2>({1s, 10s});
+    auto mx = stdex::rollup_ring<int, stdex::rollup_max, 2, 2>({1s, 10s});
+    auto ls = stdex::rollup_ring<int, stdex::rollup_last, 2, 2>({1s, 10s});
+    auto values = std::vector<int>{5, 3, 8, 4, 7};
+    for (auto i = 0u; i < values.size(); i++)
+    {
+        auto t = at(i * 1s);
+        mn.push_back(values[i], t);
+        mx.push_back(values[i], t);
+        ls.push_back(values[i], t);
+    }
+
+    // seconds 0 to 2 were rolled up into the first 10 second bucket
+    EXPECT_EQ(3, mn.tier<1>().front().value);
+    EXPECT_EQ(8, mx.tier<1>().front().value);
+    EXPECT_EQ(8, ls.tier<1>().front().value);
+    EXPECT_EQ(4, mn.tier<0>().front().value);
+}
+
+TEST(rollup_ring, late_sample)
+{
+    auto r = stdex::rollup_ring<int, stdex::rollup_sum, 10>({1s});
+    r.push_back(1, at(5s));
+    r.push_back(2, at(3s));
+    ASSERT_EQ(1u, r.size());
+    EXPECT_EQ(3, r.tier<0>().back().value);
+
+    r.clear();
+    EXPECT_TRUE(r.empty());
+}
@@ -0,0 +1,161 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <stdex/snapshot_ring.h>
+
+TEST(snapshot_ring, default_contructor)
+{
+    auto r = stdex::snapshot_ring<int, 10>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+    EXPECT_TRUE(r.snapshot().empty());
+}
+
+TEST(snapshot_ring, snapshot_in_order)
+{
+    auto r = stdex::snapshot_ring<int, 4>();
+    r.push_back(1);
+    r.push_back(2);
+    r.push_back(3);
+    EXPECT_EQ(3u, r.size());
+    EXPECT_EQ(std::vector<int>({1, 2, 3}), r.snapshot());
+
+    r.push_back(4);
+    r.push_back(5);
+    r.push_back(6);
+    EXPECT_EQ(4u, r.size());
+    EXPECT_EQ(6u, r.next_sequence());
+    EXPECT_EQ(std::vector<int>({3, 4, 5, 6}), r.snapshot());
+}
+
+TEST(snapshot_ring, snapshot_of_partial_ring)
+{
+    auto r = stdex::snapshot_ring<int, 1024>();
+    r.push_back(1);
+    r.push_back(2);
+    auto values = r.snapshot();
+    EXPECT_EQ(std::vector<int>({1, 2}), values);
+    EXPECT_GE(values.capacity(), 2u);
+    EXPECT_LT(values.capacity(), 1024u);
+}
+
+TEST(snapshot_ring, snapshot_newest_into_buffer)
+{
+    auto r = stdex::snapshot_ring<int, 8>();
+    for (auto i = 0; i < 10; i++)
+    {
+        r.push_back(i);
+    }
+
+    auto buffer = std::vector<int>(3);
+    EXPECT_EQ(3u, r.snapshot(stdex::array_span<int>(buffer.data(), buffer.size())));
+    EXPECT_EQ(std::vector<int>({7, 8, 9}), buffer);
+}
+
+TEST(snapshot_ring, visit_segments)
+{
+    auto r = stdex::snapshot_ring<int, 4>();
+    for (auto i = 0; i < 6; i++)
+    {
+        r.push_back(i);
+    }
+
+    auto values = std::vector<int>();
+    auto ok = r.try_visit([&] (stdex::array_view<int> a, stdex::array_view<int> b) {
+        values.assign(a.begin(), a.end());
+        values.insert(values.end(), b.begin(), b.end());
+    });
+    EXPECT_TRUE(ok);
+    EXPECT_EQ(std::vector<int>({2, 3, 4, 5}), values);
+
+    auto sum = 0;
+    r.visit([&] (stdex::array_view<int> a, stdex::array_view<int> b) {
+        sum = 0;
+        for (auto v : a) { sum += v; }
+        for (auto v : b) { sum += v; }
+    });
+    EXPECT_EQ(14, sum);
+}
+
+TEST(snapshot_ring, odd_sized_elements)
+{
+    struct rgb
+    {
+        std::uint8_t r, g, b;
+    };
+
+    auto r = stdex::snapshot_ring<rgb, 4>();
+    for (auto i = 0; i < 6; i++)
+    {
+        r.push_back({static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i + 10), static_cast<std::uint8_t>(i + 20)});
+    }
+
+    auto values = r.snapshot();
+    ASSERT_EQ(4u, values.size());
+    EXPECT_EQ(2, values.front().r);
+    EXPECT_EQ(25, values.back().b);
+
+    auto visited = std::vector<int>();
+    r.visit([&] (stdex::array_view<rgb> a, stdex::array_view<rgb> b) {
+        visited.clear();
+        for (const auto& v : a) { visited.push_back(v.g); }
+        for (const auto& v : b) { visited.push_back(v.g); }
+    });
+    EXPECT_EQ(std::vector<int>({12, 13, 14, 15}), visited);
+}
+
+TEST(snapshot_ring, concurrent_snapshots_are_consistent)
+{
+    struct sample
+    {
+        std::uint64_t seq;
+        std::uint64_t check;
+    };
+
+    auto r    = std::make_unique<stdex::snapshot_ring<sample, 64>>();
+    auto done = std::atomic<bool>(false);
+
+    auto writer = std::thread([&] () {
+        for (auto i = std::uint64_t(0); i < 2000000; i++)
+        {
+            r->push_back({i, ~i});
+        }
+        done = true;
+    });
+
+    // asserting here would destroy the joinable writer, so only record
+    // the failure and check it after the join
+    auto snapshots  = 0;
+    auto consistent = true;
+    auto buffer     = std::vector<sample>(64);
+    while (!done || snapshots == 0)
+    {
+        auto n = r->snapshot(stdex::array_span<sample>(buffer.data(), buffer.size()));
+        for (auto i = 0u; i < n; i++)
+        {
+            consistent = consistent && ~buffer[i].seq == buffer[i].check;
+            consistent = consistent && (i == 0 || buffer[i - 1].seq + 1 == buffer[i].seq);
+        }
+        snapshots++;
+    }
+    writer.join();
+
+    EXPECT_TRUE(consistent);
+
+    auto last = r->snapshot();
+    ASSERT_EQ(64u, last.size());
+    EXPECT_EQ(1999999u, last.back().seq);
+}
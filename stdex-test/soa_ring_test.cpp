@@ -0,0 +1,104 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <array>
+#include <stdexcept>
+#include <vector>
+#include <stdex/soa_ring.h>
+
+TEST(soa_ring, default_contructor)
+{
+    auto r = stdex::soa_ring<float, 4, 10>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+    EXPECT_EQ(4u, r.channels());
+}
+
+TEST(soa_ring, push_back_rows)
+{
+    auto r = stdex::soa_ring<float, 3, 4>();
+    r.push_back({1.0f, 2.0f, 3.0f});
+    r.push_back({4.0f, 5.0f, 6.0f});
+
+    EXPECT_EQ(2u, r.size());
+    EXPECT_EQ((std::array<float, 3>{1.0f, 2.0f, 3.0f}), r.front());
+    EXPECT_EQ((std::array<float, 3>{4.0f, 5.0f, 6.0f}), r.back());
+    EXPECT_EQ(5.0f, r.value(1, 1));
+    EXPECT_EQ(3.0f, r.at(2, 0));
+    EXPECT_THROW(r.at(3, 0), std::out_of_range);
+    EXPECT_THROW(r.at(0, 2), std::out_of_range);
+}
+
+TEST(soa_ring, columns_wrap_as_segments)
+{
+    auto r = stdex::soa_ring<int, 2, 4>();
+    for (auto i = 0; i < 6; i++)
+    {
+        r.push_back({i, -i});
+    }
+    EXPECT_EQ(4u, r.size());
+    EXPECT_EQ(2, r.front()[0]);
+
+    auto segs = r.segments(0);
+    EXPECT_EQ(2u, segs[0].size());
+    EXPECT_EQ(2u, segs[1].size());
+    auto values = std::vector<int>(segs[0].begin(), segs[0].end());
+    values.insert(values.end(), segs[1].begin(), segs[1].end());
+    EXPECT_EQ(std::vector<int>({2, 3, 4, 5}), values);
+
+    auto neg = r.segments(1);
+    EXPECT_EQ(-2, neg[0][0]);
+    EXPECT_EQ(-5, neg[1][1]);
+}
+
+TEST(soa_ring, pop_front)
+{
+    auto r = stdex::soa_ring<int, 1, 4>();
+    for (auto i = 0; i < 4; i++)
+    {
+        r.push_back({i});
+    }
+    r.pop_front();
+    EXPECT_EQ(1, r.front()[0]);
+    r.pop_front(2);
+    EXPECT_EQ(1u, r.size());
+    EXPECT_EQ(3, r.front()[0]);
+    r.clear();
+    EXPECT_TRUE(r.empty());
+}
+
+TEST(soa_ring, free_segments_commit)
+{
+    auto r = stdex::soa_ring<int, 2, 4>();
+    r.push_back({0, 0});
+    r.push_back({1, 1});
+    r.pop_front(2);
+
+    for (auto c = 0u; c < r.channels(); c++)
+    {
+        auto free = r.free_segments(c);
+        EXPECT_EQ(2u, free[0].size());
+        EXPECT_EQ(2u, free[1].size());
+        auto v = 10 * static_cast<int>(c + 1);
+        for (auto& seg : free)
+        {
+            for (auto& x : seg)
+            {
+                x = v++;
+            }
+        }
+    }
+    r.commit(4);
+
+    EXPECT_EQ(4u, r.size());
+    EXPECT_EQ((std::array<int, 2>{10, 20}), r.front());
+    EXPECT_EQ((std::array<int, 2>{13, 23}), r.back());
+}
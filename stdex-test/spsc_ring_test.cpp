@@ -0,0 +1,213 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdex/spsc_ring.h>
+#include <stdex/algorithm.h>
+
+TEST(spsc_ring, default_contructor)
+{
+    auto r = stdex::spsc_ring<int, 10>();
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10u, r.capacity());
+}
+
+TEST(spsc_ring, push_pop)
+{
+    auto r = stdex::spsc_ring<int, 4>();
+    EXPECT_TRUE(r.try_push(1));
+    EXPECT_TRUE(r.try_push(2));
+    EXPECT_EQ(2u, r.size());
+
+    auto v = 0;
+    EXPECT_TRUE(r.try_pop(v));
+    EXPECT_EQ(1, v);
+    EXPECT_TRUE(r.try_pop(v));
+    EXPECT_EQ(2, v);
+    EXPECT_FALSE(r.try_pop(v));
+}
+
+TEST(spsc_ring, reject_when_full)
+{
+    auto r = stdex::spsc_ring<int, 4>();
+    for (auto i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(r.try_push(i));
+    }
+    EXPECT_FALSE(r.try_push(4));
+
+    auto v = 0;
+    EXPECT_TRUE(r.try_pop(v));
+    EXPECT_EQ(0, v);
+    EXPECT_TRUE(r.try_push(4));
+}
+
+TEST(spsc_ring, overwrite_when_full)
+{
+    auto r = stdex::spsc_ring<int, 4, stdex::overflow_policy::overwrite>();
+    for (auto i = 0; i < 10; i++)
+    {
+        EXPECT_TRUE(r.try_push(i));
+    }
+    EXPECT_EQ(4u, r.size());
+
+    auto result = std::vector<int>();
+    EXPECT_EQ(4u, r.try_pop(std::back_inserter(result), 10));
+
+    auto ref = std::vector<int>{6, 7, 8, 9};
+    EXPECT_EQ(ref, result);
+}
+
+TEST(spsc_ring, bulk)
+{
+    auto r = stdex::spsc_ring<int, 8>();
+    auto in = std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    EXPECT_EQ(8u, r.try_push(begin(in), end(in)));
+    EXPECT_EQ(0u, r.try_push(begin(in), end(in)));
+
+    auto out = std::vector<int>(5);
+    EXPECT_EQ(5u, r.try_pop(begin(out), 5));
+    EXPECT_EQ(2u, r.try_push(begin(in) + 8, end(in)));
+
+    auto rest = std::vector<int>();
+    EXPECT_EQ(5u, r.try_pop(std::back_inserter(rest), 100));
+
+    auto ref1 = std::vector<int>{0, 1, 2, 3, 4};
+    auto ref2 = std::vector<int>{5, 6, 7, 8, 9};
+    EXPECT_EQ(ref1, out);
+    EXPECT_EQ(ref2, rest);
+}
+
+TEST(spsc_ring, strings)
+{
+    auto r = stdex::spsc_ring<std::string, 3>();
+    EXPECT_TRUE(r.try_push("one"));
+    EXPECT_TRUE(r.try_emplace(3, 'x'));
+
+    auto v = std::string();
+    EXPECT_TRUE(r.try_pop(v));
+    EXPECT_EQ("one", v);
+
+    // the remaining element is destroyed with the ring
+    EXPECT_TRUE(r.try_push(std::string(100, 'y')));
+}
+
+TEST(spsc_ring, two_thread_throughput)
+{
+    constexpr auto count = 1000000u;
+    auto r = stdex::spsc_ring<unsigned, 1024>();
+
+    auto start = std::chrono::steady_clock::now();
+    auto producer = std::thread([&] () {
+        for (auto i = 0u; i < count; i++)
+        {
+            while (!r.try_push(i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // asserting here would destroy the joinable producer, so only
+    // record the failure and check it after the join
+    auto next = 0u;
+    auto in_order = true;
+    auto buffer = std::vector<unsigned>(64);
+    while (next < count)
+    {
+        auto n = r.try_pop(begin(buffer), buffer.size());
+        for (auto i = 0u; i < n; i++)
+        {
+            in_order = in_order && next == buffer[i];
+            next++;
+        }
+        if (n == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    EXPECT_TRUE(in_order);
+    EXPECT_TRUE(r.empty());
+    RecordProperty("items_per_second", static_cast<int>(count / elapsed.count()));
+}
+
+TEST(spsc_ring, two_thread_latency)
+{
+    constexpr auto count = 100000u;
+    auto ping = stdex::spsc_ring<unsigned, 16>();
+    auto pong = stdex::spsc_ring<unsigned, 16>();
+
+    auto echo = std::thread([&] () {
+        auto v = 0u;
+        for (auto i = 0u; i < count; i++)
+        {
+            while (!ping.try_pop(v))
+            {
+                std::this_thread::yield();
+            }
+            pong.try_push(v);
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    auto echoed = true;
+    for (auto i = 0u; i < count; i++)
+    {
+        ping.try_push(i);
+        auto v = 0u;
+        while (!pong.try_pop(v))
+        {
+            std::this_thread::yield();
+        }
+        echoed = echoed && i == v;
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+    echo.join();
+
+    EXPECT_TRUE(echoed);
+
+    RecordProperty("round_trip_ns", static_cast<int>(elapsed.count() / count));
+}
+
+TEST(spsc_ring, two_thread_overwrite)
+{
+    constexpr auto count = 100000u;
+    auto r = stdex::spsc_ring<unsigned, 64, stdex::overflow_policy::overwrite>();
+
+    auto producer = std::thread([&] () {
+        for (auto i = 1u; i <= count; i++)
+        {
+            r.try_push(i);
+        }
+    });
+
+    // elements may be dropped, but what arrives is in order
+    auto last = 0u;
+    auto in_order = true;
+    while (last != count)
+    {
+        auto v = 0u;
+        if (r.try_pop(v))
+        {
+            in_order = in_order && last < v;
+            last = v;
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(in_order);
+}
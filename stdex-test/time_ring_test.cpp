@@ -0,0 +1,126 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <stdex/time_ring.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::time_point(100s);
+}
+
+TEST(time_ring, default_contructor)
+{
+    auto r = stdex::time_ring<int>(10s);
+    EXPECT_TRUE(r.empty());
+    EXPECT_EQ(0u, r.size());
+    EXPECT_EQ(10s, r.window_size());
+}
+
+TEST(time_ring, expire_by_age)
+{
+    auto r = stdex::time_ring<int>(10s);
+    r.push_back(1, t0);
+    r.push_back(2, t0 + 4s);
+    r.push_back(3, t0 + 8s);
+
+    EXPECT_EQ(3u, r.count(t0 + 9s));
+    EXPECT_EQ(6, r.sum(t0 + 9s));
+
+    EXPECT_EQ(2u, r.count(t0 + 10s));
+    EXPECT_EQ(5, r.sum(t0 + 10s));
+
+    EXPECT_EQ(1u, r.count(t0 + 17s));
+    EXPECT_EQ(3, r.front());
+
+    EXPECT_EQ(0u, r.count(t0 + 18s));
+    EXPECT_EQ(0, r.sum(t0 + 18s));
+}
+
+TEST(time_ring, expire_on_push)
+{
+    auto r = stdex::time_ring<int>(1s);
+    for (auto i = 0; i < 100; i++)
+    {
+        r.push_back(i, t0 + i * 100ms);
+    }
+    // the window at 9.9s holds 9.0s to 9.9s
+    EXPECT_EQ(10u, r.size());
+    EXPECT_EQ(90, r.front());
+    EXPECT_EQ(99, r.back());
+}
+
+TEST(time_ring, hard_cap)
+{
+    auto r = stdex::time_ring<int>(10s, 3);
+    for (auto i = 0; i < 5; i++)
+    {
+        r.push_back(i, t0);
+    }
+    EXPECT_EQ(3u, r.count(t0));
+    EXPECT_EQ(2 + 3 + 4, r.sum(t0));
+    EXPECT_EQ(2, r.front());
+}
+
+TEST(time_ring, float_sum_does_not_drift)
+{
+    auto r = stdex::time_ring<float>(10s);
+    r.push_back(1e8f, t0);
+    r.push_back(1.0f, t0 + 5s);
+    // the large value swallowed the small one in the running sum
+    EXPECT_EQ(1.0f, r.sum(t0 + 10s));
+    r.push_back(1.0f, t0 + 11s);
+    EXPECT_EQ(2.0f, r.sum(t0 + 11s));
+
+    r.push_back(1e8f, t0 + 20s);
+    r.push_back(0.5f, t0 + 20s);
+    EXPECT_EQ(0.0f, r.sum(t0 + 40s));
+    r.push_back(0.25f, t0 + 40s);
+    EXPECT_EQ(0.25f, r.sum(t0 + 40s));
+}
+
+TEST(time_ring, zero_max_size)
+{
+    EXPECT_THROW(stdex::time_ring<int>(10s, 0), std::invalid_argument);
+}
+
+TEST(time_ring, out_of_order_time)
+{
+    auto r = stdex::time_ring<int>(10s);
+    r.push_back(1, t0 + 5s);
+    r.push_back(2, t0);
+
+    EXPECT_EQ(t0 + 5s, (r.end() - 1)->time);
+    EXPECT_EQ(2u, r.count(t0 + 14s));
+}
+
+TEST(time_ring, strings)
+{
+    auto r = stdex::time_ring<std::string>(10s);
+    r.push_back("one", t0);
+    r.emplace_at(t0 + 5s, 3, 'x');
+
+    EXPECT_EQ(1u, r.count(t0 + 12s));
+    EXPECT_EQ("xxx", r.front());
+}
+
+TEST(time_ring, real_clock)
+{
+    auto r = stdex::time_ring<int>(1h);
+    r.push_back(1);
+    r.push_back(2);
+    EXPECT_EQ(2u, r.count());
+    EXPECT_EQ(3, r.sum());
+}
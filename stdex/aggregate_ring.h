@@ -0,0 +1,341 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include <type_traits>
+
+#include "ring.h"
+
+namespace stdex
+{
+    template <typename T, std::size_t MS, typename Op, typename Container = std::deque<T>>
+    class fold_ring;
+
+    //! Aggregate Ring
+    //!
+    //! A sliding window over the last MS samples that keeps its sum, mean,
+    //! variance, minimum and maximum up to date as samples are pushed and
+    //! evicted, so that every query is O(1).
+    //!
+    //! The count, sum, mean and sum of squared deviations of the samples
+    //! are folded through a fold_ring, merging partial windows like Chan's
+    //! parallel variance algorithm. Since nothing is ever subtracted,
+    //! evicting a large sample does not cost the remaining ones precision.
+    //! The minimum and maximum are the fronts of two monotonic deques, which
+    //! makes push_back O(1) amortized. All of these live on the heap, so
+    //! the ring stays small and cheap to move for large windows.
+    template <typename T, std::size_t MS, typename Container = std::deque<T>>
+    class aggregate_ring
+    {
+        static_assert(std::is_arithmetic_v<T>, "type must be arithmetic");
+
+    public:
+        using ring_type       = ring<T, MS, Container>;
+        using value_type      = T;
+        using size_type       = typename ring_type::size_type;
+        using const_reference = typename ring_type::const_reference;
+        using const_iterator  = typename ring_type::const_iterator;
+
+        aggregate_ring() = default;
+
+        explicit aggregate_ring(std::initializer_list<T> inilst)
+        {
+            for (const auto& value : inilst)
+            {
+                push_back(value);
+            }
+        }
+
+        const_reference front() const noexcept
+        {
+            return values.front();
+        }
+
+        const_reference back() const noexcept
+        {
+            return values.back();
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return values.begin();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return values.end();
+        }
+
+        bool empty() const noexcept
+        {
+            return values.empty();
+        }
+
+        size_type size() const noexcept
+        {
+            return values.size();
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Add a sample, evicting the oldest sample when full.
+        void push_back(const T& value)
+        {
+            if (values.size() == capacity())
+            {
+                pop_front();
+            }
+
+            auto seq = next_seq++;
+            values.push_back(value);
+            stats.push_back(moments{1.0, value, static_cast<double>(value), 0.0});
+
+            while (!minimums.empty() && !(minimums.back().first < value))
+            {
+                minimums.pop_back();
+            }
+            minimums.push_back(std::make_pair(value, seq));
+
+            while (!maximums.empty() && !(value < maximums.back().first))
+            {
+                maximums.pop_back();
+            }
+            maximums.push_back(std::make_pair(value, seq));
+        }
+
+        //! Remove the oldest sample.
+        void pop_front()
+        {
+            auto seq = next_seq - values.size();
+            values.pop_front();
+            stats.pop_front();
+
+            if (minimums.front().second == seq)
+            {
+                minimums.pop_front();
+            }
+            if (maximums.front().second == seq)
+            {
+                maximums.pop_front();
+            }
+        }
+
+        void clear() noexcept
+        {
+            values.clear();
+            minimums.clear();
+            maximums.clear();
+            stats.clear();
+        }
+
+        //! Sum of the samples in the window.
+        T sum() const noexcept
+        {
+            return values.empty() ? T(0) : stats.fold().sum;
+        }
+
+        //! Arithmetic mean of the samples in the window.
+        double mean() const noexcept
+        {
+            return values.empty() ? 0.0 : stats.fold().mean;
+        }
+
+        //! Population variance of the samples in the window.
+        double variance() const noexcept
+        {
+            if (values.empty())
+            {
+                return 0.0;
+            }
+            auto m = stats.fold();
+            return std::max(m.m2, 0.0) / m.count;
+        }
+
+        //! Smallest sample in the window; the window must not be empty.
+        const_reference min() const noexcept
+        {
+            assert(!minimums.empty());
+            return minimums.front().first;
+        }
+
+        //! Largest sample in the window; the window must not be empty.
+        const_reference max() const noexcept
+        {
+            assert(!maximums.empty());
+            return maximums.front().first;
+        }
+
+    private:
+        using entry = std::pair<T, std::uint64_t>;
+
+        //! Count, sum, mean and sum of squared deviations of a run of samples.
+        struct moments
+        {
+            double count = 0.0;
+            T      sum   = T(0);
+            double mean  = 0.0;
+            double m2    = 0.0;
+        };
+
+        //! Merge the moments of two adjacent runs.
+        struct merge
+        {
+            moments operator () (const moments& a, const moments& b) const noexcept
+            {
+                auto count = a.count + b.count;
+                auto delta = b.mean - a.mean;
+                return moments{count, static_cast<T>(a.sum + b.sum), a.mean + delta * (b.count / count), a.m2 + b.m2 + delta * delta * (a.count * b.count / count)};
+            }
+        };
+
+        ring_type                       values;
+        fold_ring<moments, MS, merge>   stats;
+        std::deque<entry>               minimums;
+        std::deque<entry>               maximums;
+        std::uint64_t                   next_seq = 0;
+    };
+
+    //! Fold Ring
+    //!
+    //! A sliding window over the last MS values that keeps the fold of the
+    //! window under an associative operation, such as gcd or bitwise or, in
+    //! O(1) amortized time per push.
+    //!
+    //! The window is split in two stacks. New values go on the back stack,
+    //! which only keeps the fold of its values. When the oldest value is
+    //! evicted and the front stack is empty, the back stack is moved to the
+    //! front stack, storing for every value the fold from it to the end of
+    //! the front stack. The operation does not need to be commutative or
+    //! have an identity.
+    //!
+    //! The values are kept in a ring on Container and the front stack in a
+    //! std::deque, so nothing of size MS is stored inside the object.
+    template <typename T, std::size_t MS, typename Op, typename Container>
+    class fold_ring
+    {
+    public:
+        using ring_type       = ring<T, MS, Container>;
+        using value_type      = T;
+        using size_type       = typename ring_type::size_type;
+        using const_reference = typename ring_type::const_reference;
+        using const_iterator  = typename ring_type::const_iterator;
+
+        explicit fold_ring(Op o = Op())
+        : op(std::move(o)) {}
+
+        const_reference front() const noexcept
+        {
+            return values.front();
+        }
+
+        const_reference back() const noexcept
+        {
+            return values.back();
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return values.begin();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return values.end();
+        }
+
+        bool empty() const noexcept
+        {
+            return values.empty();
+        }
+
+        size_type size() const noexcept
+        {
+            return values.size();
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Add a value, evicting the oldest value when full.
+        void push_back(const T& value)
+        {
+            if (values.size() == capacity())
+            {
+                pop_front();
+            }
+            values.push_back(value);
+            back_fold = back_count == 0 ? value : op(back_fold, value);
+            back_count++;
+        }
+
+        //! Remove the oldest value.
+        void pop_front()
+        {
+            if (suffix.empty())
+            {
+                flip();
+            }
+            values.pop_front();
+            suffix.pop_front();
+        }
+
+        void clear() noexcept
+        {
+            values.clear();
+            suffix.clear();
+            back_count = 0;
+        }
+
+        //! Fold of all values in the window; the window must not be empty.
+        T fold() const
+        {
+            assert(!values.empty());
+            if (suffix.empty())
+            {
+                return back_fold;
+            }
+            const auto& front_fold = suffix.front();
+            return back_count == 0 ? front_fold : op(front_fold, back_fold);
+        }
+
+    private:
+        ring_type      values;
+        std::deque<T>  suffix;
+        T              back_fold  = T();
+        size_type      back_count = 0;
+        Op             op;
+
+        void flip()
+        {
+            // suffix holds, for every value of the front stack, the fold
+            // from it to the back of the stack
+            auto i   = values.rbegin();
+            auto acc = *i;
+            suffix.push_front(acc);
+            for (++i; i != values.rend(); ++i)
+            {
+                acc = op(*i, acc);
+                suffix.push_front(acc);
+            }
+            back_count = 0;
+        }
+    };
+}
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <cassert>
 #include <cstddef>
 #include <stdexcept>
 #include <iterator>
@@ -287,4 +288,92 @@ namespace stdex
     {
         return array_view<T>(d, l);
     }
+
+    //! Array Span
+    //!
+    //! The writable counterpart of array_view; it refers to contiguous data
+    //! that may be modified through the span.
+    template <typename T>
+    class array_span
+    {
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference       = value_type&;
+        using pointer         = value_type*;
+        using iterator        = pointer;
+
+        array_span() noexcept = default;
+
+        array_span(pointer d, size_type s) noexcept
+        : _data(d), _size(s) {}
+
+        array_span(std::vector<T>& vec) noexcept
+        : _data(vec.data()), _size(vec.size()) {}
+
+        template <size_t N>
+        array_span(std::array<T, N>& arr) noexcept
+        : _data(arr.data()), _size(arr.size()) {}
+
+        array_span(const array_span<T>& other) noexcept = default;
+        array_span(array_span<T>&& other) noexcept = default;
+
+        ~array_span() = default;
+
+        array_span<T>& operator = (const array_span<T>& other) noexcept = default;
+        array_span<T>& operator = (array_span<T>&& other) noexcept = default;
+
+        operator array_view<T> () const noexcept
+        {
+            return array_view<T>(_data, _size);
+        }
+
+        reference operator [] (size_type i) const noexcept
+        {
+            assert(i < _size);
+            return _data[i];
+        }
+
+        pointer data() const noexcept
+        {
+            return _data;
+        }
+
+        iterator begin() const noexcept
+        {
+            return _data;
+        }
+
+        iterator end() const noexcept
+        {
+            return _data + _size;
+        }
+
+        bool empty() const noexcept
+        {
+            return _size == 0;
+        }
+
+        size_type size() const noexcept
+        {
+            return _size;
+        }
+
+    private:
+        pointer   _data = nullptr;
+        size_type _size = 0;
+    };
+
+    template <typename T>
+    auto begin(const array_span<T>& as) noexcept
+    {
+        return as.begin();
+    }
+
+    template <typename T>
+    auto end(const array_span<T>& as) noexcept
+    {
+        return as.end();
+    }
 }
@@ -0,0 +1,270 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+#include "concurrency.h"
+#include "mpmc_ring.h"
+
+namespace stdex
+{
+    //! Blocking Ring
+    //!
+    //! A bounded queue of MS elements for producer consumer pipelines, where
+    //! threads wait for space or elements instead of polling.
+    //!
+    //! The elements are held in a lock free mpmc_ring. A thread that can not
+    //! make progress first spins for a short while and then sleeps on a
+    //! condition variable. The other side only takes the lock and notifies
+    //! when it sees a registered waiter, so pushes and pops that do not need
+    //! to wait or wake anyone never make a system call.
+    template <typename T, std::size_t MS>
+    class blocking_ring
+    {
+    public:
+        using value_type = T;
+        using size_type  = std::size_t;
+
+        blocking_ring() = default;
+        blocking_ring(const blocking_ring<T, MS>&) = delete;
+        blocking_ring(blocking_ring<T, MS>&&) = delete;
+        ~blocking_ring() = default;
+        blocking_ring<T, MS>& operator = (const blocking_ring<T, MS>&) = delete;
+        blocking_ring<T, MS>& operator = (blocking_ring<T, MS>&&) = delete;
+
+        size_type size() const noexcept
+        {
+            return queue.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return queue.empty();
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Close the ring.
+        //!
+        //! Pushes fail from now on and all waiting threads are woken up;
+        //! consumers can still pop the remaining elements. Waits for pushes
+        //! already under way, so once close returns or closed is true no
+        //! more elements are added.
+        void close()
+        {
+            closing.store(true);
+            auto b = backoff{};
+            while (pushing.load() != 0)
+            {
+                b.pause();
+            }
+            {
+                auto lock = std::lock_guard<std::mutex>(mutex);
+                is_closed.store(true);
+            }
+            not_empty.notify_all();
+            not_full.notify_all();
+        }
+
+        bool closed() const noexcept
+        {
+            return is_closed.load(std::memory_order_acquire);
+        }
+
+        //! Push an element without waiting.
+        //!
+        //! @return false if the ring is full or closed
+        bool try_push(const T& value)
+        {
+            return notify_pushed(raw_push(value));
+        }
+
+        //! Push an element without waiting.
+        //!
+        //! @return false if the ring is full or closed
+        bool try_push(T&& value)
+        {
+            return notify_pushed(raw_push(std::move(value)));
+        }
+
+        //! Pop an element without waiting.
+        //!
+        //! @return false if the ring is empty
+        bool try_pop(T& value)
+        {
+            return notify_popped(queue.try_pop(value));
+        }
+
+        //! Push an element, waiting while the ring is full.
+        //!
+        //! @return false if the ring is closed
+        bool push_wait(const T& value)
+        {
+            return notify_pushed(wait_until(waiting_producers, not_full, no_deadline(), [&] () { return raw_push(value); }));
+        }
+
+        //! Push an element, waiting while the ring is full.
+        //!
+        //! @return false if the ring is closed
+        bool push_wait(T&& value)
+        {
+            return notify_pushed(wait_until(waiting_producers, not_full, no_deadline(), [&] () { return raw_push(std::move(value)); }));
+        }
+
+        //! Push an element, waiting at most timeout while the ring is full.
+        //!
+        //! @return false if the ring is closed or the timeout expired
+        template <typename Rep, typename Period>
+        bool push_wait_for(const T& value, const std::chrono::duration<Rep, Period>& timeout)
+        {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            return notify_pushed(wait_until(waiting_producers, not_full, deadline, [&] () { return raw_push(value); }));
+        }
+
+        //! Pop an element, waiting while the ring is empty.
+        //!
+        //! @return false if the ring is closed and empty
+        bool pop_wait(T& value)
+        {
+            return notify_popped(wait_until(waiting_consumers, not_empty, no_deadline(), [&] () { return queue.try_pop(value); }));
+        }
+
+        //! Pop an element, waiting at most timeout while the ring is empty.
+        //!
+        //! @return false if the ring is closed and empty or the timeout expired
+        template <typename Rep, typename Period>
+        bool pop_wait_for(T& value, const std::chrono::duration<Rep, Period>& timeout)
+        {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            return notify_popped(wait_until(waiting_consumers, not_empty, deadline, [&] () { return queue.try_pop(value); }));
+        }
+
+    private:
+        static constexpr unsigned int spin_count = 8;
+
+        mpmc_ring<T, MS>        queue;
+        std::mutex              mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+        std::atomic<unsigned>   waiting_producers = {0};
+        std::atomic<unsigned>   waiting_consumers = {0};
+        // pushes fail once closing is set; is_closed is set once no push is under way
+        std::atomic<bool>       closing           = {false};
+        std::atomic<bool>       is_closed         = {false};
+        std::atomic<unsigned>   pushing           = {0};
+
+        static std::chrono::steady_clock::time_point no_deadline() noexcept
+        {
+            return std::chrono::steady_clock::time_point::max();
+        }
+
+        template <typename... Args>
+        bool raw_push(Args&&... args)
+        {
+            // pairs with close: either close waits for this push or the push sees closing
+            pushing.fetch_add(1);
+            auto pushed = !closing.load() && queue.try_emplace(std::forward<Args>(args)...);
+            pushing.fetch_sub(1, std::memory_order_release);
+            return pushed;
+        }
+
+        bool notify_pushed(bool pushed)
+        {
+            if (pushed)
+            {
+                wake(waiting_consumers, not_empty);
+            }
+            return pushed;
+        }
+
+        bool notify_popped(bool popped)
+        {
+            if (popped)
+            {
+                wake(waiting_producers, not_full);
+            }
+            return popped;
+        }
+
+        //! Wake one thread waiting on cv, if there is any.
+        void wake(std::atomic<unsigned>& waiters, std::condition_variable& cv)
+        {
+            // pairs with the fence in wait_until: either the waiter sees
+            // the change to the queue or we see the waiter
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters.load(std::memory_order_relaxed) != 0)
+            {
+                // taking the lock ensures the waiter is inside wait
+                auto lock = std::lock_guard<std::mutex>(mutex);
+                cv.notify_one();
+            }
+        }
+
+        //! Run op until it succeeds, the ring is closed or deadline passed.
+        //!
+        //! op is run with the lock held, so it must not call wake.
+        template <typename Op>
+        bool wait_until(std::atomic<unsigned>& waiters, std::condition_variable& cv, std::chrono::steady_clock::time_point deadline, Op op)
+        {
+            auto b = backoff{};
+            for (auto i = 0u; i < spin_count; i++)
+            {
+                if (op())
+                {
+                    return true;
+                }
+                if (closed())
+                {
+                    // a pop may still find an element pushed before closing
+                    return op();
+                }
+                b.pause();
+            }
+
+            auto lock = std::unique_lock<std::mutex>(mutex);
+            waiters.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto result = false;
+            while (true)
+            {
+                if (op())
+                {
+                    result = true;
+                    break;
+                }
+                if (closed())
+                {
+                    result = op();
+                    break;
+                }
+                if (deadline == no_deadline())
+                {
+                    cv.wait(lock);
+                }
+                else if (cv.wait_until(lock, deadline) == std::cv_status::timeout)
+                {
+                    result = op();
+                    break;
+                }
+            }
+            waiters.fetch_sub(1);
+            return result;
+        }
+    };
+}
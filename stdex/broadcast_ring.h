@@ -0,0 +1,192 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <type_traits>
+
+#include "concurrency.h"
+
+namespace stdex
+{
+    //! Broadcast Ring
+    //!
+    //! A single writer, multi reader ring with MS slots. Every reader has its
+    //! own cursor and sees every element, so one copy of each element serves
+    //! any number of readers.
+    //!
+    //! The writer never waits for readers and overwrites the oldest slot. A
+    //! reader that falls more than MS elements behind is lapped; it skips to
+    //! the oldest element still available and counts the ones it missed.
+    //! Every slot is guarded by a sequence lock, a reader copies the element
+    //! and retries if the writer touched the slot meanwhile. This requires
+    //! T to be trivially copyable. The element is stored as atomic_words,
+    //! so the copy is not a data race, also for ThreadSanitizer.
+    template <typename T, std::size_t MS>
+    class broadcast_ring
+    {
+        static_assert(MS > 0, "ring capacity must not be zero");
+        static_assert(std::is_trivially_copyable_v<T>, "broadcast_ring requires a trivially copyable type");
+
+    public:
+        using value_type = T;
+        using size_type  = std::size_t;
+
+        class reader;
+
+        broadcast_ring() noexcept = default;
+        broadcast_ring(const broadcast_ring<T, MS>&) = delete;
+        broadcast_ring(broadcast_ring<T, MS>&&) = delete;
+        ~broadcast_ring() = default;
+        broadcast_ring<T, MS>& operator = (const broadcast_ring<T, MS>&) = delete;
+        broadcast_ring<T, MS>& operator = (broadcast_ring<T, MS>&&) = delete;
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Sequence number of the next element written.
+        std::uint64_t next_sequence() const noexcept
+        {
+            return write_pos.load(std::memory_order_acquire);
+        }
+
+        //! Publish an element to all readers. (writer)
+        void push_back(const T& value) noexcept
+        {
+            auto pos = write_pos.load(std::memory_order_relaxed);
+            auto& s  = slots[pos % MS];
+
+            // odd while writing, even once the element for pos is complete
+            s.seq.store(2 * pos + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            s.value.store(value);
+            s.seq.store(2 * pos + 2, std::memory_order_release);
+
+            write_pos.store(pos + 1, std::memory_order_release);
+        }
+
+        //! Create a reader that sees the elements written from now on.
+        reader subscribe() const noexcept
+        {
+            return reader(this, next_sequence());
+        }
+
+        //! Create a reader that starts with the oldest element available.
+        reader subscribe_oldest() const noexcept
+        {
+            auto w = next_sequence();
+            return reader(this, w > MS ? w - MS : 0);
+        }
+
+        //! Reader
+        //!
+        //! A cursor into a broadcast ring. Readers are independent of each
+        //! other; a single reader must only be used by one thread at a time.
+        class reader
+        {
+        public:
+            reader() noexcept = default;
+
+            //! Number of elements that can be read right now.
+            size_type available() const noexcept
+            {
+                auto w = owner->next_sequence();
+                return static_cast<size_type>(w - cursor > MS ? MS : w - cursor);
+            }
+
+            //! Sequence number of the next element this reader returns.
+            std::uint64_t sequence() const noexcept
+            {
+                return cursor;
+            }
+
+            //! Number of elements skipped because the reader was lapped.
+            std::uint64_t missed() const noexcept
+            {
+                return skipped;
+            }
+
+            //! Read the next element.
+            //!
+            //! @return false if the reader is caught up with the writer
+            bool try_pop(T& value) noexcept
+            {
+                while (true)
+                {
+                    auto w = owner->write_pos.load(std::memory_order_acquire);
+                    if (cursor == w)
+                    {
+                        return false;
+                    }
+                    if (w - cursor > MS)
+                    {
+                        skipped += w - cursor - MS;
+                        cursor   = w - MS;
+                    }
+
+                    const auto& s = owner->slots[cursor % MS];
+                    auto s1 = s.seq.load(std::memory_order_acquire);
+                    if (s1 == 2 * cursor + 2)
+                    {
+                        s.value.load(value);
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        if (s.seq.load(std::memory_order_relaxed) == s1)
+                        {
+                            cursor++;
+                            return true;
+                        }
+                    }
+                    // the slot was overwritten, so we were lapped; try again
+                }
+            }
+
+            //! Read up to n elements.
+            //!
+            //! @return the number of elements written to out
+            template <typename OutputIt>
+            size_type try_pop(OutputIt out, size_type n) noexcept
+            {
+                auto count = size_type(0);
+                auto value = T();
+                while (count < n && try_pop(value))
+                {
+                    *out = value;
+                    ++out;
+                    ++count;
+                }
+                return count;
+            }
+
+        private:
+            const broadcast_ring<T, MS>* owner   = nullptr;
+            std::uint64_t                cursor  = 0;
+            std::uint64_t                skipped = 0;
+
+            reader(const broadcast_ring<T, MS>* o, std::uint64_t c) noexcept
+            : owner(o), cursor(c) {}
+
+            friend class broadcast_ring<T, MS>;
+        };
+
+    private:
+        struct slot
+        {
+            std::atomic<std::uint64_t> seq = {0};
+            atomic_words<T>            value;
+        };
+
+        alignas(cache_line_size) std::atomic<std::uint64_t> write_pos = {0};
+        alignas(cache_line_size) slot                       slots[MS];
+    };
+}
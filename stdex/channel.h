@@ -0,0 +1,644 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#endif
+
+#include "ring.h"
+
+namespace stdex
+{
+    //! Channel
+    //!
+    //! A bounded channel of MS elements for asynchronous pipelines. A push
+    //! onto a full channel and a pop from an empty channel do not block the
+    //! thread; the operation is parked and completed when the other side
+    //! makes room or delivers a value. A value pushed while a pop is parked
+    //! is handed over directly.
+    //!
+    //! Parked operations are completed inline, on the thread that unparks
+    //! them, or on the executor passed to the constructor. The executor is
+    //! called with a function that completes the operation.
+    //!
+    //! The asynchronous operations take a callback: async_push calls it with
+    //! whether the value was pushed and async_pop with the value, or nullopt
+    //! once the channel is closed and drained. Only operations that park
+    //! allocate. The coroutine API is C++20 only: when compiled with
+    //! coroutine support, push, pop and pop_batch return awaitables, so
+    //! that a coroutine can co_await them without any allocation. The
+    //! channel tests are built as C++20 for this reason.
+    //!
+    //! Destroying the channel closes it.
+    template <typename T, std::size_t MS>
+    class channel
+    {
+        static_assert(MS > 0, "channel capacity must not be zero");
+
+    public:
+        using value_type    = T;
+        using size_type     = std::size_t;
+        using executor_type = std::function<void (std::function<void ()>)>;
+
+        //! Create a channel.
+        //!
+        //! @param exec runs the completion of parked operations, inline if empty
+        explicit channel(executor_type exec = executor_type())
+        : executor(std::move(exec)) {}
+
+        channel(const channel<T, MS>&) = delete;
+
+        ~channel()
+        {
+            close();
+        }
+
+        channel<T, MS>& operator = (const channel<T, MS>&) = delete;
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Number of buffered values.
+        size_type size() const
+        {
+            auto guard = std::lock_guard<std::mutex>(mutex);
+            return buffer.size();
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        bool closed() const
+        {
+            auto guard = std::lock_guard<std::mutex>(mutex);
+            return is_closed;
+        }
+
+        //! Close the channel.
+        //!
+        //! Parked pushes complete with false and parked pops with nullopt.
+        //! Buffered values can still be popped.
+        void close()
+        {
+            auto ready = waiter_list();
+            {
+                auto guard = std::lock_guard<std::mutex>(mutex);
+                is_closed = true;
+                while (auto w = pushers.pop())
+                {
+                    static_cast<push_waiter*>(w)->pushed = false;
+                    ready.push(w);
+                }
+                while (auto w = poppers.pop())
+                {
+                    ready.push(w);
+                }
+            }
+            dispatch(ready);
+        }
+
+        //! Push a value if there is room.
+        //!
+        //! @return false if the channel is full or closed
+        bool try_push(const T& value)
+        {
+            return offer(value);
+        }
+
+        //! Push a value if there is room.
+        //!
+        //! The value is only moved from if it was pushed.
+        //!
+        //! @return false if the channel is full or closed
+        bool try_push(T&& value)
+        {
+            return offer(std::move(value));
+        }
+
+        //! Push a value, evicting the oldest one when the channel is full.
+        //!
+        //! This never parks, like pushing onto a ring.
+        //!
+        //! @return false if the channel is closed
+        bool force_push(const T& value)
+        {
+            return force(value);
+        }
+
+        //! Push a value, evicting the oldest one when the channel is full.
+        //!
+        //! The value is only moved from if it was pushed.
+        //!
+        //! @return false if the channel is closed
+        bool force_push(T&& value)
+        {
+            return force(std::move(value));
+        }
+
+        //! Pop a value if there is one.
+        std::optional<T> try_pop()
+        {
+            auto ready  = waiter_list();
+            auto result = std::optional<T>();
+            {
+                auto guard = std::lock_guard<std::mutex>(mutex);
+                if (!buffer.empty())
+                {
+                    result.emplace(take(ready));
+                }
+            }
+            dispatch(ready);
+            return result;
+        }
+
+        //! Pop up to n values to out.
+        //!
+        //! @return the number of values popped
+        template <typename OutputIt>
+        size_type try_pop_n(OutputIt out, size_type n)
+        {
+            auto ready = waiter_list();
+            auto count = size_type(0);
+            {
+                auto guard = std::lock_guard<std::mutex>(mutex);
+                for (; count < n && !buffer.empty(); count++)
+                {
+                    *out++ = take(ready);
+                }
+            }
+            dispatch(ready);
+            return count;
+        }
+
+        //! Push a value, parking the push while the channel is full.
+        //!
+        //! @param fn called with true once the value is pushed, or false if the channel is closed
+        //!
+        //! When the value can be pushed right away, fn is called inline and
+        //! nothing is allocated; only a parked push allocates its waiter.
+        template <typename Fn>
+        void async_push(T value, Fn&& fn)
+        {
+            auto ready  = waiter_list();
+            auto pushed = false;
+            {
+                auto guard = std::lock_guard<std::mutex>(mutex);
+                if (!is_closed)
+                {
+                    if (!push_locked(std::move(value), ready))
+                    {
+                        // once parked, the channel owns the operation
+                        pushers.push(new callback_push<std::decay_t<Fn>>(std::move(value), std::forward<Fn>(fn)));
+                        return;
+                    }
+                    pushed = true;
+                }
+            }
+            dispatch(ready);
+            fn(pushed);
+        }
+
+        //! Pop a value, parking the pop while the channel is empty.
+        //!
+        //! @param fn called with the value, or nullopt if the channel is closed and empty
+        //!
+        //! When a value is buffered or the channel is closed, fn is called
+        //! inline and nothing is allocated; only a parked pop allocates its
+        //! waiter.
+        template <typename Fn>
+        void async_pop(Fn&& fn)
+        {
+            auto ready  = waiter_list();
+            auto result = std::optional<T>();
+            {
+                auto guard = std::lock_guard<std::mutex>(mutex);
+                if (buffer.empty())
+                {
+                    if (!is_closed)
+                    {
+                        // once parked, the channel owns the operation
+                        poppers.push(new callback_pop<std::decay_t<Fn>>(std::forward<Fn>(fn)));
+                        return;
+                    }
+                }
+                else
+                {
+                    result.emplace(take(ready));
+                }
+            }
+            dispatch(ready);
+            fn(std::move(result));
+        }
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+        class push_awaiter;
+        class pop_awaiter;
+        template <typename OutputIt>
+        class batch_awaiter;
+
+        //! Await pushing a value; the result is false if the channel is closed.
+        push_awaiter push(T value)
+        {
+            return push_awaiter(*this, std::move(value));
+        }
+
+        //! Await popping a value; the result is nullopt if the channel is closed and empty.
+        pop_awaiter pop()
+        {
+            return pop_awaiter(*this);
+        }
+
+        //! Await at least one value and pop up to n values to out.
+        //!
+        //! The result is the number of values popped, 0 if the channel is
+        //! closed and empty.
+        template <typename OutputIt>
+        batch_awaiter<OutputIt> pop_batch(OutputIt out, size_type n)
+        {
+            return batch_awaiter<OutputIt>(*this, out, n);
+        }
+#endif
+
+    private:
+        //! A parked operation.
+        struct waiter
+        {
+            waiter* next = nullptr;
+
+            virtual void complete() = 0;
+
+        protected:
+            ~waiter() = default;
+        };
+
+        struct push_waiter : waiter
+        {
+            T    value;
+            bool pushed = true;
+
+            explicit push_waiter(T v)
+            : value(std::move(v)) {}
+        };
+
+        struct pop_waiter : waiter
+        {
+            std::optional<T> result;
+        };
+
+        //! An intrusive first in first out list of waiters.
+        class waiter_list
+        {
+        public:
+            void push(waiter* w) noexcept
+            {
+                w->next = nullptr;
+                if (tail != nullptr)
+                {
+                    tail->next = w;
+                }
+                else
+                {
+                    head = w;
+                }
+                tail = w;
+            }
+
+            waiter* pop() noexcept
+            {
+                auto w = head;
+                if (w != nullptr)
+                {
+                    head = w->next;
+                    if (head == nullptr)
+                    {
+                        tail = nullptr;
+                    }
+                }
+                return w;
+            }
+
+            bool empty() const noexcept
+            {
+                return head == nullptr;
+            }
+
+        private:
+            waiter* head = nullptr;
+            waiter* tail = nullptr;
+        };
+
+        template <typename Fn>
+        struct callback_push final : push_waiter
+        {
+            Fn fn;
+
+            callback_push(T v, Fn f)
+            : push_waiter(std::move(v)), fn(std::move(f)) {}
+
+            void complete() override
+            {
+                auto self = std::unique_ptr<callback_push>(this);
+                fn(this->pushed);
+            }
+        };
+
+        template <typename Fn>
+        struct callback_pop final : pop_waiter
+        {
+            Fn fn;
+
+            explicit callback_pop(Fn f)
+            : fn(std::move(f)) {}
+
+            void complete() override
+            {
+                auto self = std::unique_ptr<callback_pop>(this);
+                fn(std::move(this->result));
+            }
+        };
+
+        mutable std::mutex            mutex;
+        ring<T, MS, inline_storage>   buffer;
+        waiter_list                   pushers;
+        waiter_list                   poppers;
+        bool                          is_closed = false;
+        executor_type                 executor;
+
+        //! Complete the waiters made ready, outside of the lock.
+        void dispatch(waiter_list& ready)
+        {
+            while (auto w = ready.pop())
+            {
+                if (executor)
+                {
+                    executor([w] () { w->complete(); });
+                }
+                else
+                {
+                    w->complete();
+                }
+            }
+        }
+
+        //! Give the value to a parked pop, if there is one; the lock is held.
+        //!
+        //! The value is left untouched if there is no parked pop.
+        template <typename U>
+        bool hand_over(U&& value, waiter_list& ready)
+        {
+            auto w = static_cast<pop_waiter*>(poppers.pop());
+            if (w == nullptr)
+            {
+                return false;
+            }
+            w->result.emplace(std::forward<U>(value));
+            ready.push(w);
+            return true;
+        }
+
+        //! Hand the value over or buffer it; the lock is held.
+        //!
+        //! @return false and leave the value untouched if the channel is full
+        template <typename U>
+        bool push_locked(U&& value, waiter_list& ready)
+        {
+            if (hand_over(std::forward<U>(value), ready))
+            {
+                return true;
+            }
+            if (buffer.size() == MS)
+            {
+                return false;
+            }
+            buffer.push_back(std::forward<U>(value));
+            return true;
+        }
+
+        //! Push without parking.
+        template <typename U>
+        bool offer(U&& value)
+        {
+            auto ready = waiter_list();
+            {
+                auto guard = std::lock_guard<std::mutex>(mutex);
+                if (is_closed)
+                {
+                    return false;
+                }
+                if (!push_locked(std::forward<U>(value), ready))
+                {
+                    return false;
+                }
+            }
+            dispatch(ready);
+            return true;
+        }
+
+        //! Push without parking, evicting the oldest value when full.
+        template <typename U>
+        bool force(U&& value)
+        {
+            auto ready = waiter_list();
+            {
+                auto guard = std::lock_guard<std::mutex>(mutex);
+                if (is_closed)
+                {
+                    return false;
+                }
+                if (!hand_over(std::forward<U>(value), ready))
+                {
+                    buffer.push_back(std::forward<U>(value));
+                }
+            }
+            dispatch(ready);
+            return true;
+        }
+
+        //! Pop the front and refill from a parked push; the lock is held.
+        T take(waiter_list& ready)
+        {
+            auto value = std::move(buffer.front());
+            buffer.pop_front();
+            if (auto w = static_cast<push_waiter*>(pushers.pop()))
+            {
+                buffer.push_back(std::move(w->value));
+                ready.push(w);
+            }
+            return value;
+        }
+
+        //! Push or park w.
+        //!
+        //! @return true if w is done and was not parked
+        bool push_or_park(push_waiter& w)
+        {
+            auto ready = waiter_list();
+            {
+                auto guard = std::lock_guard<std::mutex>(mutex);
+                if (is_closed)
+                {
+                    w.pushed = false;
+                    return true;
+                }
+                if (!push_locked(std::move(w.value), ready))
+                {
+                    pushers.push(&w);
+                    return false;
+                }
+            }
+            dispatch(ready);
+            return true;
+        }
+
+        //! Pop into w or park w.
+        //!
+        //! @return true if w is done and was not parked
+        bool pop_or_park(pop_waiter& w)
+        {
+            auto ready = waiter_list();
+            {
+                auto guard = std::lock_guard<std::mutex>(mutex);
+                if (buffer.empty())
+                {
+                    if (is_closed)
+                    {
+                        return true;
+                    }
+                    poppers.push(&w);
+                    return false;
+                }
+                w.result.emplace(take(ready));
+            }
+            dispatch(ready);
+            return true;
+        }
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+    public:
+        class push_awaiter : private push_waiter
+        {
+        public:
+            push_awaiter(channel<T, MS>& c, T v)
+            : push_waiter(std::move(v)), owner(c) {}
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            bool await_suspend(std::coroutine_handle<> h)
+            {
+                handle = h;
+                return !owner.push_or_park(*this);
+            }
+
+            bool await_resume() const noexcept
+            {
+                return this->pushed;
+            }
+
+        private:
+            channel<T, MS>&         owner;
+            std::coroutine_handle<> handle;
+
+            void complete() override
+            {
+                handle.resume();
+            }
+        };
+
+        class pop_awaiter : private pop_waiter
+        {
+        public:
+            explicit pop_awaiter(channel<T, MS>& c)
+            : owner(c) {}
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            bool await_suspend(std::coroutine_handle<> h)
+            {
+                handle = h;
+                return !owner.pop_or_park(*this);
+            }
+
+            std::optional<T> await_resume()
+            {
+                return std::move(this->result);
+            }
+
+        private:
+            channel<T, MS>&         owner;
+            std::coroutine_handle<> handle;
+
+            void complete() override
+            {
+                handle.resume();
+            }
+        };
+
+        template <typename OutputIt>
+        class batch_awaiter : private pop_waiter
+        {
+        public:
+            batch_awaiter(channel<T, MS>& c, OutputIt o, size_type n)
+            : owner(c), out(o), max(n) {}
+
+            bool await_ready()
+            {
+                count = owner.try_pop_n(out, max);
+                return count != 0 || max == 0;
+            }
+
+            bool await_suspend(std::coroutine_handle<> h)
+            {
+                handle = h;
+                return !owner.pop_or_park(*this);
+            }
+
+            size_type await_resume()
+            {
+                if (count == 0 && this->result)
+                {
+                    *out++ = std::move(*this->result);
+                    count  = 1 + owner.try_pop_n(out, max - 1);
+                }
+                return count;
+            }
+
+        private:
+            channel<T, MS>&         owner;
+            OutputIt                out;
+            size_type               max;
+            size_type               count = 0;
+            std::coroutine_handle<> handle;
+
+            void complete() override
+            {
+                handle.resume();
+            }
+        };
+#endif
+    };
+}
@@ -0,0 +1,565 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <deque>
+#include <initializer_list>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#endif
+
+namespace stdex
+{
+    //! Compressed Ring
+    //!
+    //! A ring over the last MS numeric samples that keeps them compressed
+    //! in blocks of BS samples, for long histories of slowly changing
+    //! metrics.
+    //!
+    //! Floating point samples are encoded like in Facebook's Gorilla: each
+    //! value is XORed with its predecessor and only the meaningful bits of
+    //! the result are stored, so a repeated value costs a single bit.
+    //! Integral samples are stored as the zigzag encoded difference between
+    //! consecutive deltas, so a counter or timestamp that advances at a
+    //! steady rate costs a single bit per sample as well.
+    //!
+    //! Every block starts with a raw sample and can be decoded on its own.
+    //! Evicted samples are skipped when iterating until the whole front
+    //! block is evicted and freed. Samples can only be read sequentially
+    //! through the iterators.
+    template <typename T, std::size_t MS, std::size_t BS = 1024>
+    class compressed_ring
+    {
+        static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "compressed_ring requires an integral or floating point type");
+        static_assert(sizeof(T) <= sizeof(std::uint64_t), "compressed_ring supports at most 64 bit samples");
+        static_assert(MS > 0, "ring capacity must not be zero");
+        static_assert(BS > 0, "block size must not be zero");
+
+        //! A bit stream holding up to BS encoded samples.
+        struct block
+        {
+            std::vector<std::uint64_t> words;
+            std::size_t                bits  = 0;
+            std::size_t                count = 0;
+        };
+
+        //! The state shared by the encoder and the decoder.
+        struct codec
+        {
+            std::uint64_t prev  = 0;
+            std::uint64_t delta = 0;
+            // out of range until the first window is written
+            unsigned      lead  = 0xff;
+            unsigned      trail = 0;
+        };
+
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using const_reference = const T&;
+        using const_pointer   = const T*;
+
+        class const_iterator;
+        using iterator = const_iterator;
+
+        compressed_ring() noexcept = default;
+
+        compressed_ring(std::initializer_list<T> init)
+        {
+            for (auto value : init)
+            {
+                push_back(value);
+            }
+        }
+
+        template <typename InputIt>
+        compressed_ring(InputIt first, InputIt last)
+        {
+            for (; first != last; ++first)
+            {
+                push_back(*first);
+            }
+        }
+
+        compressed_ring(const compressed_ring<T, MS, BS>&) = default;
+        compressed_ring(compressed_ring<T, MS, BS>&&) noexcept = default;
+        ~compressed_ring() = default;
+        compressed_ring<T, MS, BS>& operator = (const compressed_ring<T, MS, BS>&) = default;
+        compressed_ring<T, MS, BS>& operator = (compressed_ring<T, MS, BS>&&) noexcept = default;
+
+        //! The oldest sample.
+        //!
+        //! This decodes the front block up to the first sample that is not
+        //! evicted, so it takes up to O(BS).
+        T front() const noexcept
+        {
+            return *begin();
+        }
+
+        //! The newest sample.
+        T back() const noexcept
+        {
+            return from_bits(encoder.prev);
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return const_iterator(*this);
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return const_iterator(*this);
+        }
+
+        const_iterator end() const noexcept
+        {
+            return const_iterator(size());
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return const_iterator(size());
+        }
+
+        bool empty() const noexcept
+        {
+            return total == skip;
+        }
+
+        size_type size() const noexcept
+        {
+            return total - skip;
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        constexpr size_type block_size() const noexcept
+        {
+            return BS;
+        }
+
+        //! Number of allocated blocks.
+        size_type block_count() const noexcept
+        {
+            return blocks.size();
+        }
+
+        //! Approximate number of bytes used by the ring and its blocks.
+        size_type memory_usage() const noexcept
+        {
+            auto bytes = sizeof(*this) + blocks.size() * sizeof(block);
+            for (const auto& b : blocks)
+            {
+                bytes += b.words.capacity() * sizeof(std::uint64_t);
+            }
+            return bytes;
+        }
+
+        //! Append a sample and evict the oldest one when the ring is full.
+        void push_back(T value)
+        {
+            if (blocks.empty() || blocks.back().count == BS)
+            {
+                if (!blocks.empty())
+                {
+                    // the block is sealed, release the slack of the bit stream
+                    blocks.back().words.shrink_to_fit();
+                }
+                blocks.emplace_back();
+                blocks.back().words.reserve(BS / 16 + 1);
+                encoder = codec();
+            }
+            encode(blocks.back(), encoder, to_bits(value));
+            total++;
+
+            if (total - skip > MS)
+            {
+                skip++;
+                if (skip == blocks.front().count)
+                {
+                    total -= skip;
+                    skip   = 0;
+                    blocks.pop_front();
+                }
+            }
+        }
+
+        void clear() noexcept
+        {
+            blocks.clear();
+            skip    = 0;
+            total   = 0;
+            encoder = codec();
+        }
+
+        void swap(compressed_ring<T, MS, BS>& other) noexcept
+        {
+            std::swap(blocks, other.blocks);
+            std::swap(skip, other.skip);
+            std::swap(total, other.total);
+            std::swap(encoder, other.encoder);
+        }
+
+        //! Decodes the samples one by one.
+        //!
+        //! The reference returned points into the iterator and is only valid
+        //! until it is incremented, so this is an input iterator.
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const T*;
+            using reference         = const T&;
+
+            const_iterator() noexcept = default;
+
+            reference operator * () const noexcept
+            {
+                return value;
+            }
+
+            pointer operator -> () const noexcept
+            {
+                return &value;
+            }
+
+            const_iterator& operator ++ () noexcept
+            {
+                index++;
+                if (index < count)
+                {
+                    next();
+                }
+                return *this;
+            }
+
+            const_iterator operator ++ (int) noexcept
+            {
+                auto old = *this;
+                ++(*this);
+                return old;
+            }
+
+            bool operator == (const const_iterator& other) const noexcept
+            {
+                return index == other.index;
+            }
+
+            bool operator != (const const_iterator& other) const noexcept
+            {
+                return index != other.index;
+            }
+
+        private:
+            typename std::deque<block>::const_iterator current;
+            size_type   index    = 0;
+            size_type   count    = 0;
+            size_type   in_block = 0;
+            std::size_t pos      = 0;
+            codec       state;
+            T           value    = T();
+
+            explicit const_iterator(size_type end) noexcept
+            : index(end), count(end) {}
+
+            explicit const_iterator(const compressed_ring<T, MS, BS>& owner) noexcept
+            : current(owner.blocks.begin()), count(owner.size())
+            {
+                if (count != 0)
+                {
+                    value = from_bits(decode(*current, pos, state, 0));
+                    for (auto i = 0u; i < owner.skip; i++)
+                    {
+                        next();
+                    }
+                }
+            }
+
+            void next() noexcept
+            {
+                in_block++;
+                if (in_block == current->count)
+                {
+                    ++current;
+                    in_block = 0;
+                    pos      = 0;
+                    state    = codec();
+                }
+                value = from_bits(decode(*current, pos, state, in_block));
+            }
+
+            friend class compressed_ring<T, MS, BS>;
+        };
+
+    private:
+        static constexpr unsigned width = std::is_floating_point_v<T> ? sizeof(T) * 8 : 64;
+
+        std::deque<block> blocks;
+        size_type         skip    = 0;
+        size_type         total   = 0;
+        codec             encoder;
+
+        static std::uint64_t to_bits(T value) noexcept
+        {
+            if constexpr (std::is_same_v<T, float>)
+            {
+                std::uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return bits;
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                std::uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return bits;
+            }
+            else
+            {
+                return static_cast<std::uint64_t>(value);
+            }
+        }
+
+        static T from_bits(std::uint64_t bits) noexcept
+        {
+            if constexpr (std::is_same_v<T, float>)
+            {
+                auto narrow = static_cast<std::uint32_t>(bits);
+                float value;
+                std::memcpy(&value, &narrow, sizeof(value));
+                return value;
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                T value;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+            else
+            {
+                return static_cast<T>(bits);
+            }
+        }
+
+        static unsigned leading_zeros(std::uint64_t x) noexcept
+        {
+            assert(x != 0);
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+            unsigned long i;
+            _BitScanReverse64(&i, x);
+            return 63u - i;
+#elif defined(__GNUC__)
+            return static_cast<unsigned>(__builtin_clzll(x));
+#else
+            auto n = 0u;
+            for (; (x & (std::uint64_t(1) << 63)) == 0; x <<= 1)
+            {
+                n++;
+            }
+            return n;
+#endif
+        }
+
+        static unsigned trailing_zeros(std::uint64_t x) noexcept
+        {
+            assert(x != 0);
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+            unsigned long i;
+            _BitScanForward64(&i, x);
+            return i;
+#elif defined(__GNUC__)
+            return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+            auto n = 0u;
+            for (; (x & 1) == 0; x >>= 1)
+            {
+                n++;
+            }
+            return n;
+#endif
+        }
+
+        //! Append the n low bits of v to the stream.
+        static void put(block& b, std::uint64_t v, unsigned n)
+        {
+            auto off = static_cast<unsigned>(b.bits % 64);
+            if (off == 0)
+            {
+                b.words.push_back(0);
+            }
+            b.words.back() |= v << off;
+            if (off + n > 64)
+            {
+                b.words.push_back(v >> (64 - off));
+            }
+            b.bits += n;
+        }
+
+        //! Read n bits from the stream at pos.
+        static std::uint64_t get(const block& b, std::size_t& pos, unsigned n) noexcept
+        {
+            auto i   = pos / 64;
+            auto off = static_cast<unsigned>(pos % 64);
+            auto v   = b.words[i] >> off;
+            if (off + n > 64)
+            {
+                v |= b.words[i + 1] << (64 - off);
+            }
+            pos += n;
+            return n < 64 ? v & ((std::uint64_t(1) << n) - 1) : v;
+        }
+
+        static void encode(block& b, codec& c, std::uint64_t v)
+        {
+            if (b.count == 0)
+            {
+                put(b, v, width);
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                auto x = v ^ c.prev;
+                if (x == 0)
+                {
+                    put(b, 0, 1);
+                }
+                else
+                {
+                    auto lead  = std::min(leading_zeros(x) - (64 - width), 31u);
+                    auto trail = trailing_zeros(x);
+                    if (lead >= c.lead && trail >= c.trail)
+                    {
+                        // the meaningful bits fit into the previous window
+                        put(b, 0b01, 2);
+                        put(b, x >> c.trail, width - c.lead - c.trail);
+                    }
+                    else
+                    {
+                        auto len = width - lead - trail;
+                        put(b, 0b11, 2);
+                        put(b, lead, 5);
+                        put(b, len - 1, 6);
+                        put(b, x >> trail, len);
+                        c.lead  = lead;
+                        c.trail = trail;
+                    }
+                }
+            }
+            else
+            {
+                auto delta = v - c.prev;
+                auto dod   = delta - c.delta;
+                auto zz    = (dod << 1) ^ (0 - (dod >> 63));
+                if (zz == 0)
+                {
+                    put(b, 0, 1);
+                }
+                else if (zz < (1u << 7))
+                {
+                    put(b, 0b01, 2);
+                    put(b, zz, 7);
+                }
+                else if (zz < (1u << 9))
+                {
+                    put(b, 0b011, 3);
+                    put(b, zz, 9);
+                }
+                else if (zz < (1u << 12))
+                {
+                    put(b, 0b0111, 4);
+                    put(b, zz, 12);
+                }
+                else
+                {
+                    put(b, 0b1111, 4);
+                    put(b, zz, 64);
+                }
+                c.delta = delta;
+            }
+            c.prev = v;
+            b.count++;
+        }
+
+        static std::uint64_t decode(const block& b, std::size_t& pos, codec& c, size_type i) noexcept
+        {
+            std::uint64_t v;
+            if (i == 0)
+            {
+                v = get(b, pos, width);
+            }
+            else if constexpr (std::is_floating_point_v<T>)
+            {
+                if (get(b, pos, 1) == 0)
+                {
+                    v = c.prev;
+                }
+                else
+                {
+                    if (get(b, pos, 1) == 1)
+                    {
+                        c.lead  = static_cast<unsigned>(get(b, pos, 5));
+                        c.trail = width - c.lead - static_cast<unsigned>(get(b, pos, 6)) - 1;
+                    }
+                    v = c.prev ^ (get(b, pos, width - c.lead - c.trail) << c.trail);
+                }
+            }
+            else
+            {
+                auto zz = std::uint64_t(0);
+                if (get(b, pos, 1) == 0)
+                {
+                    zz = 0;
+                }
+                else if (get(b, pos, 1) == 0)
+                {
+                    zz = get(b, pos, 7);
+                }
+                else if (get(b, pos, 1) == 0)
+                {
+                    zz = get(b, pos, 9);
+                }
+                else if (get(b, pos, 1) == 0)
+                {
+                    zz = get(b, pos, 12);
+                }
+                else
+                {
+                    zz = get(b, pos, 64);
+                }
+                auto dod = (zz >> 1) ^ (0 - (zz & 1));
+                c.delta += dod;
+                v = c.prev + c.delta;
+            }
+            c.prev = v;
+            return v;
+        }
+    };
+
+    template <typename T, std::size_t MS, std::size_t BS>
+    void swap(compressed_ring<T, MS, BS>& a, compressed_ring<T, MS, BS>& b) noexcept
+    {
+        a.swap(b);
+    }
+}
@@ -0,0 +1,166 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+#if defined(__SANITIZE_THREAD__)
+#define STDEX_THREAD_SANITIZER
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define STDEX_THREAD_SANITIZER
+#endif
+#endif
+
+#ifdef STDEX_THREAD_SANITIZER
+extern "C" void AnnotateIgnoreReadsBegin(const char* file, int line);
+extern "C" void AnnotateIgnoreReadsEnd(const char* file, int line);
+#endif
+
+namespace stdex
+{
+    //! Assumed size of a cache line.
+    //!
+    //! Data written by different threads is aligned to this boundary to
+    //! avoid false sharing. std::hardware_destructive_interference_size
+    //! is not reliably available, so this is fixed to the common 64 bytes.
+    inline constexpr std::size_t cache_line_size = 64;
+
+    //! Hint to the CPU that the caller is spinning.
+    inline void cpu_relax() noexcept
+    {
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+        _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+    //! Exponential Backoff
+    //!
+    //! Spins with an exponentially growing number of pause instructions and
+    //! yields the thread once the spin limit is reached.
+    class backoff
+    {
+    public:
+        void pause() noexcept
+        {
+            if (step < spin_limit)
+            {
+                for (auto i = 0u; i < (1u << step); i++)
+                {
+                    cpu_relax();
+                }
+                step++;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        void reset() noexcept
+        {
+            step = 0;
+        }
+
+    private:
+        static constexpr unsigned int spin_limit = 6;
+        unsigned int step = 0;
+    };
+
+    //! Sequence Lock Read
+    //!
+    //! Marks the reads of a sequence lock reader that copies data in place
+    //! while the writer may write it and checks afterwards whether the copy
+    //! is torn. ThreadSanitizer ignores the reads made while an object of
+    //! this class lives; otherwise it does nothing. Prefer atomic_words
+    //! where the data does not have to be read in place.
+    class seqlock_read_scope
+    {
+    public:
+        seqlock_read_scope() noexcept
+        {
+#ifdef STDEX_THREAD_SANITIZER
+            AnnotateIgnoreReadsBegin(__FILE__, __LINE__);
+#endif
+        }
+
+        seqlock_read_scope(const seqlock_read_scope&) = delete;
+
+        ~seqlock_read_scope()
+        {
+#ifdef STDEX_THREAD_SANITIZER
+            AnnotateIgnoreReadsEnd(__FILE__, __LINE__);
+#endif
+        }
+
+        seqlock_read_scope& operator = (const seqlock_read_scope&) = delete;
+    };
+
+    //! Atomic Words
+    //!
+    //! A trivially copyable value stored as relaxed atomic words, for the
+    //! payload of a sequence lock. The reader copies the value while the
+    //! writer may store it and only afterwards checks whether the copy is
+    //! torn. Going through atomic words makes that copy free of data races,
+    //! so it is well defined and ThreadSanitizer does not report it. The
+    //! ordering is left to the sequence around the copy.
+    //!
+    //! The words are the widest of std::size_t, 32, 16 and 8 bits that
+    //! divide sizeof(T), so atomic_words<T> is as large as T and an array
+    //! of them has the layout of an array of T.
+    template <typename T>
+    class atomic_words
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "atomic_words requires a trivially copyable type");
+
+    public:
+        void store(const T& value) noexcept
+        {
+            word_type buffer[word_count] = {};
+            std::memcpy(buffer, &value, sizeof(T));
+            for (auto i = std::size_t(0); i < word_count; i++)
+            {
+                words[i].store(buffer[i], std::memory_order_relaxed);
+            }
+        }
+
+        void load(T& value) const noexcept
+        {
+            word_type buffer[word_count];
+            for (auto i = std::size_t(0); i < word_count; i++)
+            {
+                buffer[i] = words[i].load(std::memory_order_relaxed);
+            }
+            std::memcpy(&value, buffer, sizeof(T));
+        }
+
+    private:
+        using word_type = std::conditional_t<sizeof(T) % sizeof(std::size_t) == 0, std::size_t,
+                          std::conditional_t<sizeof(T) % sizeof(std::uint32_t) == 0, std::uint32_t,
+                          std::conditional_t<sizeof(T) % sizeof(std::uint16_t) == 0, std::uint16_t, std::uint8_t>>>;
+
+        static constexpr std::size_t word_count = sizeof(T) / sizeof(word_type);
+
+        std::atomic<word_type> words[word_count];
+    };
+}
@@ -0,0 +1,178 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory_resource>
+
+#include "ring.h"
+
+namespace stdex
+{
+    //! Size in bytes of the chunks a std::deque<T> allocates its elements in.
+    //!
+    //! This is derived from container_block_size; the deque's map of chunk
+    //! pointers is allocated separately and may be larger.
+    template <typename T>
+    constexpr std::size_t deque_chunk_size() noexcept
+    {
+        return container_block_size_v<std::deque<T>> * sizeof(T);
+    }
+
+    //! Fixed Block Resource
+    //!
+    //! A memory resource that hands out blocks of one fixed size from a
+    //! free list, carving them from chunks obtained from an upstream
+    //! resource. Requests that do not fit into a block are passed to the
+    //! upstream resource.
+    //!
+    //! With the block size set to deque_chunk_size<T>, the element chunks
+    //! of many short lived stdex::pmr::ring<T, MS> are recycled instead of
+    //! going through the global heap. Freed blocks are kept until the
+    //! resource is destroyed. Like std::pmr::unsynchronized_pool_resource
+    //! the resource is not thread safe.
+    class fixed_block_resource : public std::pmr::memory_resource
+    {
+    public:
+        //! Create a fixed block resource.
+        //!
+        //! @param block_size the size of the blocks handed out
+        //! @param blocks_per_chunk how many blocks to request from upstream at once
+        //! @param upstream_resource where chunks and large requests are allocated
+        explicit fixed_block_resource(std::size_t block_size, std::size_t blocks_per_chunk = 64,
+                                      std::pmr::memory_resource* upstream_resource = std::pmr::get_default_resource())
+        : size(round_up(block_size < sizeof(free_block) ? sizeof(free_block) : block_size, alignment)),
+          per_chunk(blocks_per_chunk > 0 ? blocks_per_chunk : 1),
+          upstream(upstream_resource) {}
+
+        fixed_block_resource(const fixed_block_resource&) = delete;
+
+        ~fixed_block_resource()
+        {
+            release();
+        }
+
+        fixed_block_resource& operator = (const fixed_block_resource&) = delete;
+
+        std::size_t block_size() const noexcept
+        {
+            return size;
+        }
+
+        //! Number of chunks obtained from upstream.
+        std::size_t chunk_count() const noexcept
+        {
+            return chunks;
+        }
+
+        std::pmr::memory_resource* upstream_resource() const noexcept
+        {
+            return upstream;
+        }
+
+        //! Return all chunks to upstream.
+        //!
+        //! Blocks still in use become invalid.
+        void release() noexcept
+        {
+            while (chunk_list != nullptr)
+            {
+                auto next = chunk_list->next;
+                upstream->deallocate(chunk_list, chunk_bytes(), alignment);
+                chunk_list = next;
+            }
+            free_list = nullptr;
+            chunks    = 0;
+        }
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t align) override
+        {
+            if (!fits(bytes, align))
+            {
+                return upstream->allocate(bytes, align);
+            }
+
+            if (free_list == nullptr)
+            {
+                grow();
+            }
+            auto block = free_list;
+            free_list = block->next;
+            return block;
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t align) override
+        {
+            if (!fits(bytes, align))
+            {
+                upstream->deallocate(p, bytes, align);
+                return;
+            }
+
+            auto block = static_cast<free_block*>(p);
+            block->next = free_list;
+            free_list   = block;
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        struct free_block
+        {
+            free_block* next;
+        };
+
+        static constexpr std::size_t alignment = alignof(std::max_align_t);
+
+        std::size_t                size;
+        std::size_t                per_chunk;
+        std::pmr::memory_resource* upstream;
+        free_block*                free_list  = nullptr;
+        // the first block of each chunk links the chunks
+        free_block*                chunk_list = nullptr;
+        std::size_t                chunks     = 0;
+
+        static constexpr std::size_t round_up(std::size_t n, std::size_t a) noexcept
+        {
+            return (n + a - 1) / a * a;
+        }
+
+        bool fits(std::size_t bytes, std::size_t align) const noexcept
+        {
+            return bytes <= size && align <= alignment;
+        }
+
+        std::size_t chunk_bytes() const noexcept
+        {
+            return (per_chunk + 1) * size;
+        }
+
+        void grow()
+        {
+            auto chunk = static_cast<char*>(upstream->allocate(chunk_bytes(), alignment));
+            auto link  = reinterpret_cast<free_block*>(chunk);
+            link->next = chunk_list;
+            chunk_list = link;
+            chunks++;
+
+            for (auto i = per_chunk; i > 0; i--)
+            {
+                auto block = reinterpret_cast<free_block*>(chunk + i * size);
+                block->next = free_list;
+                free_list   = block;
+            }
+        }
+    };
+}
@@ -0,0 +1,437 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "array_view.h"
+
+namespace stdex
+{
+    //! Hash for lru_cache keys.
+    template <typename K>
+    struct lru_hash : std::hash<K> {};
+
+    //! Hash for string keys that also hashes views of the string.
+    //!
+    //! A std::basic_string, std::basic_string_view, array_view or C string
+    //! with the same characters hash to the same value.
+    template <typename C, typename Tr, typename A>
+    struct lru_hash<std::basic_string<C, Tr, A>>
+    {
+        using is_transparent = void;
+
+        template <typename Key>
+        std::size_t operator () (const Key& key) const noexcept
+        {
+            return std::hash<std::basic_string_view<C, Tr>>()(view(key));
+        }
+
+        static std::basic_string_view<C, Tr> view(const std::basic_string<C, Tr, A>& s) noexcept
+        {
+            return s;
+        }
+
+        static std::basic_string_view<C, Tr> view(std::basic_string_view<C, Tr> s) noexcept
+        {
+            return s;
+        }
+
+        static std::basic_string_view<C, Tr> view(const array_view<C>& s) noexcept
+        {
+            return std::basic_string_view<C, Tr>(s.data(), s.size());
+        }
+
+        static std::basic_string_view<C, Tr> view(const C* s) noexcept
+        {
+            return s;
+        }
+    };
+
+    //! Key comparison for lru_cache keys.
+    template <typename K>
+    struct lru_equal : std::equal_to<K> {};
+
+    //! Key comparison for string keys that also accepts views of strings.
+    template <typename C, typename Tr, typename A>
+    struct lru_equal<std::basic_string<C, Tr, A>>
+    {
+        using is_transparent = void;
+
+        template <typename Key>
+        bool operator () (const std::basic_string<C, Tr, A>& a, const Key& b) const noexcept
+        {
+            return lru_hash<std::basic_string<C, Tr, A>>::view(a) == lru_hash<std::basic_string<C, Tr, A>>::view(b);
+        }
+    };
+
+    //! Size of the lru_cache index for ms entries.
+    //!
+    //! The smallest power of two that keeps the table at most half full.
+    constexpr std::size_t lru_table_size(std::size_t ms) noexcept
+    {
+        auto size = std::size_t(2);
+        while (size < 2 * ms)
+        {
+            size *= 2;
+        }
+        return size;
+    }
+
+    //! Least Recently Used Cache
+    //!
+    //! A map of at most MS entries that evicts the least recently used
+    //! entry when full, as a replacement for a ring searched with std::find.
+    //!
+    //! The entries live in a fixed array and are linked in recency order
+    //! by their indices. An open addressing table with linear probing and
+    //! at most half load maps the keys to the entries. Lookup, insert and
+    //! eviction are O(1) and no memory is allocated after construction,
+    //! apart from what the keys and values allocate themselves.
+    //!
+    //! With the default Hash and KeyEqual, caches with string keys can be
+    //! looked up by std::string_view, array_view<char> and C strings
+    //! without building a string.
+    template <typename K, typename V, std::size_t MS, typename Hash = lru_hash<K>, typename KeyEqual = lru_equal<K>>
+    class lru_cache
+    {
+        static_assert(MS > 0, "cache capacity must not be zero");
+
+        template <typename H, typename E, typename = void>
+        struct is_transparent : std::false_type {};
+
+        template <typename H, typename E>
+        struct is_transparent<H, E, std::void_t<typename H::is_transparent, typename E::is_transparent>> : std::true_type {};
+
+        //! Lookups by other key types need a transparent Hash and KeyEqual.
+        template <typename Key>
+        using enable_lookup = std::enable_if_t<is_transparent<Hash, KeyEqual>::value, Key>;
+
+    public:
+        using key_type    = K;
+        using mapped_type = V;
+        using value_type  = std::pair<const K, V>;
+        using size_type   = std::size_t;
+        using hasher      = Hash;
+        using key_equal   = KeyEqual;
+
+        explicit lru_cache(Hash h = Hash(), KeyEqual e = KeyEqual())
+        : hash(std::move(h)), equal(std::move(e))
+        {
+            clear();
+        }
+
+        bool empty() const noexcept
+        {
+            return count == 0;
+        }
+
+        size_type size() const noexcept
+        {
+            return count;
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Number of lookups by find that found their key.
+        std::uint64_t hits() const noexcept
+        {
+            return hit_count;
+        }
+
+        //! Number of lookups by find that did not find their key.
+        std::uint64_t misses() const noexcept
+        {
+            return miss_count;
+        }
+
+        //! Number of entries evicted to make room for new ones.
+        std::uint64_t evictions() const noexcept
+        {
+            return eviction_count;
+        }
+
+        void reset_stats() noexcept
+        {
+            hit_count      = 0;
+            miss_count     = 0;
+            eviction_count = 0;
+        }
+
+        //! Look up a value and mark it as most recently used.
+        //!
+        //! @return the value or nullptr if the key is not cached
+        V* find(const K& key)
+        {
+            return find_value(key);
+        }
+
+        template <typename Key, typename = enable_lookup<Key>>
+        V* find(const Key& key)
+        {
+            return find_value(key);
+        }
+
+        //! Look up a value without marking it as used or counting the lookup.
+        const V* peek(const K& key) const
+        {
+            return peek_value(key);
+        }
+
+        template <typename Key, typename = enable_lookup<Key>>
+        const V* peek(const Key& key) const
+        {
+            return peek_value(key);
+        }
+
+        bool contains(const K& key) const
+        {
+            return peek_value(key) != nullptr;
+        }
+
+        template <typename Key, typename = enable_lookup<Key>>
+        bool contains(const Key& key) const
+        {
+            return peek_value(key) != nullptr;
+        }
+
+        //! Insert or replace the value of key and mark it as most recently used.
+        //!
+        //! When the cache is full, the least recently used entry is evicted.
+        //!
+        //! @return the cached value
+        V& insert_or_assign(K key, V value)
+        {
+            auto h   = hash(key);
+            auto pos = locate(key, h);
+            if (pos != npos)
+            {
+                auto i = table[pos];
+                nodes[i].item->second = std::move(value);
+                touch(i);
+                return nodes[i].item->second;
+            }
+
+            if (count == MS)
+            {
+                remove(tail);
+                eviction_count++;
+            }
+
+            auto i = free_head;
+            free_head = nodes[i].next;
+            nodes[i].item.emplace(std::move(key), std::move(value));
+            nodes[i].hash = h;
+            pos = home(h);
+            while (table[pos] != npos)
+            {
+                pos = (pos + 1) & mask;
+            }
+            table[pos] = i;
+            link_front(i);
+            count++;
+            return nodes[i].item->second;
+        }
+
+        //! Remove the entry of key.
+        //!
+        //! @return false if the key is not cached
+        bool erase(const K& key)
+        {
+            return erase_key(key);
+        }
+
+        template <typename Key, typename = enable_lookup<Key>>
+        bool erase(const Key& key)
+        {
+            return erase_key(key);
+        }
+
+        //! Remove all entries; the counters are kept.
+        void clear() noexcept
+        {
+            for (auto& n : nodes)
+            {
+                n.item.reset();
+            }
+            table.fill(npos);
+            for (auto i = 0u; i < MS; i++)
+            {
+                nodes[i].next = i + 1 < MS ? i + 1 : npos;
+            }
+            free_head = 0;
+            head      = npos;
+            tail      = npos;
+            count     = 0;
+        }
+
+        //! Call fn with every entry, most recently used first.
+        template <typename Fn>
+        void for_each(Fn&& fn) const
+        {
+            for (auto i = head; i != npos; i = nodes[i].next)
+            {
+                fn(*nodes[i].item);
+            }
+        }
+
+    private:
+        static constexpr size_type npos = static_cast<size_type>(-1);
+
+        static constexpr size_type mask = lru_table_size(MS) - 1;
+
+        //! The slot a hash is probed from.
+        //!
+        //! The hash is mixed by Fibonacci hashing first, since std::hash of
+        //! an integer is often the integer itself and keys that are multiples
+        //! of the table size would all start in the same slot.
+        static constexpr size_type home(std::size_t h) noexcept
+        {
+            h *= sizeof(std::size_t) == 8 ? static_cast<std::size_t>(0x9e3779b97f4a7c15ull) : static_cast<std::size_t>(0x9e3779b9u);
+            return (h ^ (h >> (std::numeric_limits<std::size_t>::digits / 2))) & mask;
+        }
+
+        struct node
+        {
+            std::optional<value_type> item;
+            std::size_t               hash = 0;
+            size_type                 prev = npos;
+            size_type                 next = npos;
+        };
+
+        std::array<node, MS>                nodes;
+        std::array<size_type, lru_table_size(MS)> table;
+        size_type                           free_head = 0;
+        // most and least recently used
+        size_type                           head      = npos;
+        size_type                           tail      = npos;
+        size_type                           count     = 0;
+        std::uint64_t                       hit_count      = 0;
+        std::uint64_t                       miss_count     = 0;
+        std::uint64_t                       eviction_count = 0;
+        Hash                                hash;
+        KeyEqual                            equal;
+
+        //! The table position of key, or npos.
+        template <typename Key>
+        size_type locate(const Key& key, std::size_t h) const
+        {
+            for (auto pos = home(h); table[pos] != npos; pos = (pos + 1) & mask)
+            {
+                const auto& n = nodes[table[pos]];
+                if (n.hash == h && equal(n.item->first, key))
+                {
+                    return pos;
+                }
+            }
+            return npos;
+        }
+
+        template <typename Key>
+        V* find_value(const Key& key)
+        {
+            auto pos = locate(key, hash(key));
+            if (pos == npos)
+            {
+                miss_count++;
+                return nullptr;
+            }
+            hit_count++;
+            touch(table[pos]);
+            return &nodes[table[pos]].item->second;
+        }
+
+        template <typename Key>
+        const V* peek_value(const Key& key) const
+        {
+            auto pos = locate(key, hash(key));
+            return pos != npos ? &nodes[table[pos]].item->second : nullptr;
+        }
+
+        template <typename Key>
+        bool erase_key(const Key& key)
+        {
+            auto pos = locate(key, hash(key));
+            if (pos == npos)
+            {
+                return false;
+            }
+            remove(table[pos]);
+            return true;
+        }
+
+        void unlink(size_type i) noexcept
+        {
+            auto& n = nodes[i];
+            (n.prev != npos ? nodes[n.prev].next : head) = n.next;
+            (n.next != npos ? nodes[n.next].prev : tail) = n.prev;
+        }
+
+        void link_front(size_type i) noexcept
+        {
+            nodes[i].prev = npos;
+            nodes[i].next = head;
+            (head != npos ? nodes[head].prev : tail) = i;
+            head = i;
+        }
+
+        void touch(size_type i) noexcept
+        {
+            if (i != head)
+            {
+                unlink(i);
+                link_front(i);
+            }
+        }
+
+        //! Remove entry i from the table, the recency list and the storage.
+        void remove(size_type i) noexcept
+        {
+            auto pos = home(nodes[i].hash);
+            while (table[pos] != i)
+            {
+                pos = (pos + 1) & mask;
+            }
+
+            // shift the following entries back, so no tombstones are needed
+            auto hole = pos;
+            for (auto next = (pos + 1) & mask; table[next] != npos; next = (next + 1) & mask)
+            {
+                auto ideal = home(nodes[table[next]].hash);
+                auto stays = hole <= next ? (hole < ideal && ideal <= next) : (hole < ideal || ideal <= next);
+                if (!stays)
+                {
+                    table[hole] = table[next];
+                    hole        = next;
+                }
+            }
+            table[hole] = npos;
+
+            unlink(i);
+            nodes[i].item.reset();
+            nodes[i].next = free_head;
+            free_head     = i;
+            count--;
+        }
+    };
+}
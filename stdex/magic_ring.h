@@ -0,0 +1,686 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <atomic>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <numeric>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+// keep the min and max macros out, but leave NOMINMAX as it was
+#ifndef NOMINMAX
+#define NOMINMAX
+#define STDEX_MAGIC_RING_NOMINMAX
+#endif
+#include <windows.h>
+#ifdef STDEX_MAGIC_RING_NOMINMAX
+#undef NOMINMAX
+#undef STDEX_MAGIC_RING_NOMINMAX
+#endif
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#endif
+
+#include "array_view.h"
+
+namespace stdex
+{
+    //! Magic Ring
+    //!
+    //! A ring of MS elements whose storage is mapped twice, back to back, in
+    //! virtual memory. Every run of up to capacity() elements starting
+    //! anywhere in the first mapping is contiguous, so the contents are
+    //! always available as a single array_view without wrap around logic.
+    //!
+    //! The storage is rounded up to the allocation granularity of the
+    //! system, so small rings cost at least one page (64 KiB on Windows).
+    //! Since the elements are shuffled around as raw memory, T must be
+    //! trivially copyable.
+    //!
+    //! On Windows this header includes <windows.h> with NOMINMAX, so the
+    //! min and max macros are not defined. NOMINMAX itself is removed
+    //! again if it was not defined before.
+    template <typename T, std::size_t MS>
+    class magic_ring
+    {
+        static_assert(MS > 0, "ring capacity must not be zero");
+        static_assert(std::is_trivially_copyable_v<T>, "magic_ring requires a trivially copyable type");
+
+    public:
+        using value_type             = T;
+        using size_type              = std::size_t;
+        using difference_type        = std::ptrdiff_t;
+        using reference              = value_type&;
+        using const_reference        = const value_type&;
+        using pointer                = value_type*;
+        using const_pointer          = const value_type*;
+        using iterator               = pointer;
+        using const_iterator         = const_pointer;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        magic_ring()
+        {
+            map();
+        }
+
+        explicit magic_ring(std::initializer_list<T> inilst)
+        : magic_ring(std::begin(inilst), std::end(inilst)) {}
+
+        template <typename InputIt>
+        magic_ring(InputIt first, InputIt last)
+        : magic_ring()
+        {
+            for (; first != last && count < capacity(); ++first)
+            {
+                push_back(*first);
+            }
+        }
+
+        magic_ring(const magic_ring<T, MS>& other)
+        : magic_ring()
+        {
+            std::memcpy(static_cast<void*>(base), other.data(), other.size() * sizeof(T));
+            count = other.count;
+        }
+
+        //! Move the storage of other.
+        //!
+        //! The moved from ring has no storage and may only be destroyed,
+        //! assigned to or swapped.
+        magic_ring(magic_ring<T, MS>&& other) noexcept
+        {
+            swap(other);
+        }
+
+        ~magic_ring()
+        {
+            unmap();
+        }
+
+        magic_ring<T, MS>& operator = (const magic_ring<T, MS>& other)
+        {
+            if (this != &other)
+            {
+                if (base == nullptr)
+                {
+                    map();
+                }
+                head  = 0;
+                count = other.count;
+                std::memcpy(static_cast<void*>(base), other.data(), other.size() * sizeof(T));
+            }
+            return *this;
+        }
+
+        magic_ring<T, MS>& operator = (magic_ring<T, MS>&& other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        reference front() noexcept
+        {
+            return base[head];
+        }
+
+        const_reference front() const noexcept
+        {
+            return base[head];
+        }
+
+        reference back() noexcept
+        {
+            return base[head + count - 1];
+        }
+
+        const_reference back() const noexcept
+        {
+            return base[head + count - 1];
+        }
+
+        pointer data() noexcept
+        {
+            return base + head;
+        }
+
+        const_pointer data() const noexcept
+        {
+            return base + head;
+        }
+
+        //! The contents as one contiguous view.
+        array_view<T> view() const noexcept
+        {
+            return array_view<T>(data(), count);
+        }
+
+        //! The contents as contiguous segments in logical order.
+        //!
+        //! Provided for parity with ring; the second segment is always empty.
+        std::array<array_view<T>, 2> segments() const noexcept
+        {
+            return {view(), array_view<T>()};
+        }
+
+        //! The free slots after the back as one contiguous span.
+        //!
+        //! The slots can be filled in place and are added to the ring with
+        //! commit.
+        array_span<T> free_span() noexcept
+        {
+            return array_span<T>(base + head + count, MS - count);
+        }
+
+        //! The free slots after the back as contiguous segments.
+        //!
+        //! Provided for parity with ring; the second segment is always empty.
+        std::array<array_span<T>, 2> free_segments() noexcept
+        {
+            return {free_span(), array_span<T>()};
+        }
+
+        //! Add n elements written through free_span to the back.
+        void commit(size_type n) noexcept
+        {
+            assert(count + n <= MS);
+            count += n;
+        }
+
+        iterator begin() noexcept
+        {
+            return data();
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return data();
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return data();
+        }
+
+        iterator end() noexcept
+        {
+            return data() + count;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return data() + count;
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return data() + count;
+        }
+
+        reverse_iterator rbegin() noexcept
+        {
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator crbegin() const noexcept
+        {
+            return const_reverse_iterator(cend());
+        }
+
+        reverse_iterator rend() noexcept
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        const_reverse_iterator crend() const noexcept
+        {
+            return const_reverse_iterator(cbegin());
+        }
+
+        bool empty() const noexcept
+        {
+            return count == 0;
+        }
+
+        size_type size() const noexcept
+        {
+            return count;
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        void push_front(const T& value) noexcept
+        {
+            emplace_front(value);
+        }
+
+        void push_back(const T& value) noexcept
+        {
+            emplace_back(value);
+        }
+
+        template <typename... Args>
+        void emplace_front(Args&&... args) noexcept
+        {
+            auto value = T(std::forward<Args>(args)...);
+            head = head == 0 ? slots - 1 : head - 1;
+            base[head] = value;
+            if (count < MS)
+            {
+                count++;
+            }
+        }
+
+        template <typename... Args>
+        void emplace_back(Args&&... args) noexcept
+        {
+            base[head + count] = T(std::forward<Args>(args)...);
+            if (count < MS)
+            {
+                count++;
+            }
+            else
+            {
+                head = head + 1 == slots ? 0 : head + 1;
+            }
+        }
+
+        void pop_front() noexcept
+        {
+            head = head + 1 == slots ? 0 : head + 1;
+            count--;
+        }
+
+        void pop_back() noexcept
+        {
+            count--;
+        }
+
+        iterator insert(const_iterator pos, const T& value) noexcept
+        {
+            return emplace(pos, value);
+        }
+
+        template <typename InputIt>
+        iterator insert(const_iterator pos, InputIt first, InputIt last) noexcept
+        {
+            auto start = static_cast<size_type>(pos - cbegin());
+            auto i     = start;
+            for (; first != last && i < capacity(); ++first, ++i)
+            {
+                emplace(cbegin() + i, *first);
+            }
+            return begin() + start;
+        }
+
+        template <typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args) noexcept
+        {
+            auto i = static_cast<size_type>(pos - cbegin());
+            if (i == capacity())
+            {
+                // inserting past the last slot is culled right away
+                return end();
+            }
+
+            auto value = T(std::forward<Args>(args)...);
+            auto moved = (count == MS ? count - 1 : count) - i;
+            std::memmove(static_cast<void*>(data() + i + 1), data() + i, moved * sizeof(T));
+            data()[i] = value;
+            if (count < MS)
+            {
+                count++;
+            }
+            return begin() + i;
+        }
+
+        //! Push a range of elements to the back.
+        //!
+        //! The result is the same as calling push_back for each element, but
+        //! only the last MS elements of the range are copied.
+        template <typename InputIt>
+        void append(InputIt first, InputIt last)
+        {
+            for (first = last_n(first, last); first != last; ++first)
+            {
+                emplace_back(*first);
+            }
+        }
+
+        //! Push a range of elements to the back.
+        void append(const array_view<T>& values) noexcept
+        {
+            auto src = values.data();
+            auto n   = values.size();
+            if (n == 0)
+            {
+                return;
+            }
+            if (n > MS)
+            {
+                src += n - MS;
+                n    = MS;
+            }
+            if (count + n > MS)
+            {
+                auto evicted = count + n - MS;
+                head   = (head + evicted) % slots;
+                count -= evicted;
+            }
+            std::memcpy(static_cast<void*>(base + head + count), src, n * sizeof(T));
+            count += n;
+        }
+
+        //! Push a range of elements to the front.
+        //!
+        //! The result is the same as calling push_front for each element, so
+        //! the last element of the range ends up at the front. Only the last
+        //! MS elements of the range are copied.
+        template <typename InputIt>
+        void prepend(InputIt first, InputIt last)
+        {
+            for (first = last_n(first, last); first != last; ++first)
+            {
+                emplace_front(*first);
+            }
+        }
+
+        //! Push a range of elements to the front.
+        void prepend(const array_view<T>& values) noexcept
+        {
+            prepend(values.begin(), values.end());
+        }
+
+        void clear() noexcept
+        {
+            head  = 0;
+            count = 0;
+        }
+
+        void swap(magic_ring<T, MS>& other) noexcept
+        {
+            std::swap(base, other.base);
+            std::swap(slots, other.slots);
+            std::swap(head, other.head);
+            std::swap(count, other.count);
+        }
+
+    private:
+        pointer   base  = nullptr;
+        size_type slots = 0;
+        size_type head  = 0;
+        size_type count = 0;
+
+        //! Skip all but the last MS elements of a forward range.
+        template <typename InputIt>
+        static InputIt last_n(InputIt first, InputIt last)
+        {
+            using category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>)
+            {
+                auto n = static_cast<size_type>(std::distance(first, last));
+                if (n > MS)
+                {
+                    std::advance(first, n - MS);
+                }
+            }
+            return first;
+        }
+
+        //! Size of the mapping in bytes.
+        //!
+        //! This is the smallest multiple of both the allocation granularity
+        //! and the element size that holds MS elements.
+        static size_type mapping_size()
+        {
+#ifdef _WIN32
+            auto info = SYSTEM_INFO{};
+            GetSystemInfo(&info);
+            auto granularity = static_cast<size_type>(info.dwAllocationGranularity);
+#else
+            auto granularity = static_cast<size_type>(sysconf(_SC_PAGESIZE));
+#endif
+            auto unit  = std::lcm(granularity, sizeof(T));
+            auto bytes = MS * sizeof(T);
+            return (bytes + unit - 1) / unit * unit;
+        }
+
+#ifdef _WIN32
+        void map()
+        {
+            auto bytes   = mapping_size();
+            auto size64  = static_cast<std::uint64_t>(bytes);
+            auto mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                              static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), nullptr);
+            if (mapping == nullptr)
+            {
+                throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "magic_ring");
+            }
+
+            // Find a free range twice the size and map both views into it.
+            // An other thread may grab the range in between, so retry.
+            for (auto attempt = 0; attempt < 16 && base == nullptr; attempt++)
+            {
+                auto address = static_cast<char*>(VirtualAlloc(nullptr, 2 * bytes, MEM_RESERVE, PAGE_NOACCESS));
+                if (address == nullptr)
+                {
+                    break;
+                }
+                VirtualFree(address, 0, MEM_RELEASE);
+
+                auto first  = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes, address);
+                auto second = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes, address + bytes);
+                if (first == address && second == address + bytes)
+                {
+                    base  = reinterpret_cast<pointer>(address);
+                    slots = bytes / sizeof(T);
+                }
+                else
+                {
+                    if (first != nullptr)
+                    {
+                        UnmapViewOfFile(first);
+                    }
+                    if (second != nullptr)
+                    {
+                        UnmapViewOfFile(second);
+                    }
+                }
+            }
+
+            auto error = GetLastError();
+            CloseHandle(mapping);
+            if (base == nullptr)
+            {
+                throw std::system_error(static_cast<int>(error), std::system_category(), "magic_ring");
+            }
+        }
+
+        void unmap() noexcept
+        {
+            if (base != nullptr)
+            {
+                auto address = reinterpret_cast<char*>(base);
+                UnmapViewOfFile(address);
+                UnmapViewOfFile(address + slots * sizeof(T));
+                base = nullptr;
+            }
+        }
+#else
+        static int open_shared_memory()
+        {
+#ifdef __linux__
+            return memfd_create("stdex::magic_ring", MFD_CLOEXEC);
+#else
+            static std::atomic<unsigned int> counter = {0};
+            auto name = "/stdex-magic-ring-" + std::to_string(getpid()) + "-" + std::to_string(counter++);
+            auto fd   = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd != -1)
+            {
+                shm_unlink(name.c_str());
+            }
+            return fd;
+#endif
+        }
+
+        void map()
+        {
+            auto bytes = mapping_size();
+            auto fd    = open_shared_memory();
+            if (fd == -1)
+            {
+                throw std::system_error(errno, std::generic_category(), "magic_ring");
+            }
+            if (ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+            {
+                auto error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "magic_ring");
+            }
+
+            // reserve twice the size, then map the memory twice over it
+            auto address = static_cast<char*>(mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            if (address == MAP_FAILED)
+            {
+                auto error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "magic_ring");
+            }
+
+            auto first  = mmap(address, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+            auto second = mmap(address + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+            auto error  = errno;
+            close(fd);
+            if (first == MAP_FAILED || second == MAP_FAILED)
+            {
+                munmap(address, 2 * bytes);
+                throw std::system_error(error, std::generic_category(), "magic_ring");
+            }
+
+            base  = reinterpret_cast<pointer>(address);
+            slots = bytes / sizeof(T);
+        }
+
+        void unmap() noexcept
+        {
+            if (base != nullptr)
+            {
+                munmap(base, 2 * slots * sizeof(T));
+                base = nullptr;
+            }
+        }
+#endif
+    };
+
+    template <typename T, std::size_t MS>
+    auto begin(magic_ring<T, MS>& r) noexcept
+    {
+        return r.begin();
+    }
+
+    template <typename T, std::size_t MS>
+    auto begin(const magic_ring<T, MS>& r) noexcept
+    {
+        return r.begin();
+    }
+
+    template <typename T, std::size_t MS>
+    auto cbegin(const magic_ring<T, MS>& r) noexcept
+    {
+        return r.cbegin();
+    }
+
+    template <typename T, std::size_t MS>
+    auto end(magic_ring<T, MS>& r) noexcept
+    {
+        return r.end();
+    }
+
+    template <typename T, std::size_t MS>
+    auto end(const magic_ring<T, MS>& r) noexcept
+    {
+        return r.end();
+    }
+
+    template <typename T, std::size_t MS>
+    auto cend(const magic_ring<T, MS>& r) noexcept
+    {
+        return r.cend();
+    }
+
+    template <typename T, std::size_t MS>
+    auto rbegin(magic_ring<T, MS>& r) noexcept
+    {
+        return r.rbegin();
+    }
+
+    template <typename T, std::size_t MS>
+    auto rbegin(const magic_ring<T, MS>& r) noexcept
+    {
+        return r.rbegin();
+    }
+
+    template <typename T, std::size_t MS>
+    auto crbegin(const magic_ring<T, MS>& r) noexcept
+    {
+        return r.crbegin();
+    }
+
+    template <typename T, std::size_t MS>
+    auto rend(magic_ring<T, MS>& r) noexcept
+    {
+        return r.rend();
+    }
+
+    template <typename T, std::size_t MS>
+    auto rend(const magic_ring<T, MS>& r) noexcept
+    {
+        return r.rend();
+    }
+
+    template <typename T, std::size_t MS>
+    auto crend(const magic_ring<T, MS>& r) noexcept
+    {
+        return r.crend();
+    }
+
+    template <typename T, std::size_t MS>
+    void swap(magic_ring<T, MS>& a, magic_ring<T, MS>& b) noexcept
+    {
+        a.swap(b);
+    }
+}
@@ -0,0 +1,225 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#include "concurrency.h"
+
+namespace stdex
+{
+    //! Multi Producer Multi Consumer Ring
+    //!
+    //! A lock free bounded queue with a fixed capacity of MS elements, after
+    //! Dmitry Vyukov's bounded MPMC queue. Every slot carries a sequence
+    //! number that tells whether it is ready to be written or read for the
+    //! current lap, so producers and consumers only contend on a single
+    //! compare and swap of their respective position.
+    //!
+    //! MS must be at least two. With a single slot, the sequence number a
+    //! filled slot gets for the current lap equals the one that marks it
+    //! free for the next lap, so a producer would overwrite an unread
+    //! element.
+    template <typename T, std::size_t MS>
+    class mpmc_ring
+    {
+        // a full and an empty slot only differ in their sequence with two or more slots
+        static_assert(MS > 1, "mpmc_ring needs at least two slots to tell full from empty");
+
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using reference       = value_type&;
+        using const_reference = const value_type&;
+
+        mpmc_ring() noexcept
+        {
+            for (auto i = size_type(0); i < MS; i++)
+            {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        mpmc_ring(const mpmc_ring<T, MS>&) = delete;
+        mpmc_ring(mpmc_ring<T, MS>&&) = delete;
+
+        ~mpmc_ring()
+        {
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                auto e = enqueue_pos.load(std::memory_order_relaxed);
+                for (auto d = dequeue_pos.load(std::memory_order_relaxed); d != e; d++)
+                {
+                    cells[d % MS].value().~T();
+                }
+            }
+        }
+
+        mpmc_ring<T, MS>& operator = (const mpmc_ring<T, MS>&) = delete;
+        mpmc_ring<T, MS>& operator = (mpmc_ring<T, MS>&&) = delete;
+
+        //! Number of elements in the queue.
+        //!
+        //! The value is only a snapshot when other threads are active.
+        size_type size() const noexcept
+        {
+            auto d = dequeue_pos.load(std::memory_order_acquire);
+            auto e = enqueue_pos.load(std::memory_order_acquire);
+            return e > d ? static_cast<size_type>(e - d) : 0;
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Push an element.
+        //!
+        //! @return false if the queue is full
+        bool try_push(const T& value)
+        {
+            return try_emplace(value);
+        }
+
+        //! Push an element.
+        //!
+        //! @return false if the queue is full
+        bool try_push(T&& value)
+        {
+            return try_emplace(std::move(value));
+        }
+
+        //! Construct an element in place.
+        //!
+        //! The arguments are only consumed when the push succeeds.
+        //!
+        //! @return false if the queue is full
+        template <typename... Args>
+        bool try_emplace(Args&&... args)
+        {
+            auto pos = enqueue_pos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                auto& c   = cells[pos % MS];
+                auto seq  = c.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::int64_t>(seq - pos);
+                if (diff == 0)
+                {
+                    if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        new (c.raw) T(std::forward<Args>(args)...);
+                        c.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        //! Pop the oldest element.
+        //!
+        //! @return false if the queue is empty
+        bool try_pop(T& value)
+        {
+            auto pos = dequeue_pos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                auto& c   = cells[pos % MS];
+                auto seq  = c.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<std::int64_t>(seq - (pos + 1));
+                if (diff == 0)
+                {
+                    if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        value = std::move(c.value());
+                        c.value().~T();
+                        c.sequence.store(pos + MS, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        //! Push an element, waiting while the queue is full.
+        void push(const T& value)
+        {
+            emplace(value);
+        }
+
+        //! Push an element, waiting while the queue is full.
+        void push(T&& value)
+        {
+            emplace(std::move(value));
+        }
+
+        //! Construct an element in place, waiting while the queue is full.
+        template <typename... Args>
+        void emplace(Args&&... args)
+        {
+            auto b = backoff{};
+            while (!try_emplace(std::forward<Args>(args)...))
+            {
+                b.pause();
+            }
+        }
+
+        //! Pop the oldest element, waiting while the queue is empty.
+        void pop(T& value)
+        {
+            auto b = backoff{};
+            while (!try_pop(value))
+            {
+                b.pause();
+            }
+        }
+
+    private:
+        struct cell
+        {
+            std::atomic<std::uint64_t> sequence;
+            alignas(T) unsigned char   raw[sizeof(T)];
+
+            T& value() noexcept
+            {
+                return *std::launder(reinterpret_cast<T*>(raw));
+            }
+        };
+
+        // positions are free running, the cell is position % MS
+        alignas(cache_line_size) std::atomic<std::uint64_t> enqueue_pos = {0};
+        alignas(cache_line_size) std::atomic<std::uint64_t> dequeue_pos = {0};
+        alignas(cache_line_size) cell                       cells[MS];
+    };
+}
@@ -0,0 +1,676 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#ifdef _WIN32
+// keep the min and max macros out, but leave NOMINMAX as it was
+#ifndef NOMINMAX
+#define NOMINMAX
+#define STDEX_PERSISTENT_RING_NOMINMAX
+#endif
+#include <windows.h>
+#ifdef STDEX_PERSISTENT_RING_NOMINMAX
+#undef NOMINMAX
+#undef STDEX_PERSISTENT_RING_NOMINMAX
+#endif
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "array_view.h"
+
+namespace stdex
+{
+    //! Persistent Ring
+    //!
+    //! A ring of MS elements stored in a memory mapped file, for flight
+    //! recorder logs that must survive a crash of the process.
+    //!
+    //! The file starts with a small header holding the format, the element
+    //! size, the capacity, a checksum of these and the head and tail
+    //! positions. The checksum only guards the fields describing the layout
+    //! against foreign files; head and tail change with every push and are
+    //! only checked to be in range. Pushing is a plain memory write
+    //! followed by an update of the tail, so the contents in the file are
+    //! consistent after every single store. Opening an existing file
+    //! recovers the contents in O(1) by mapping it; nothing is replayed. A
+    //! file of the right size whose header was not finished, left by a
+    //! crash while the file was created, is initialized again. Any other
+    //! file that does not hold a matching ring is rejected and left
+    //! untouched.
+    //!
+    //! A crash of the process loses nothing, since the mapped pages belong
+    //! to the operating system. To survive a crash of the operating system
+    //! the pages must be written back with flush, which can be done
+    //! automatically every sync_interval pushes.
+    //!
+    //! Since the file is read back by a later process, T must be trivially
+    //! copyable and must not hold pointers.
+    //!
+    //! On Windows this header includes <windows.h> with NOMINMAX, like
+    //! magic_ring.h.
+    template <typename T, std::size_t MS>
+    class persistent_ring
+    {
+        static_assert(MS > 0, "ring capacity must not be zero");
+        static_assert(std::is_trivially_copyable_v<T>, "persistent_ring requires a trivially copyable type");
+        static_assert(alignof(T) <= 64, "persistent_ring supports alignments up to 64 bytes");
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "persistent_ring requires lock free 64 bit atomics");
+
+        class basic_const_iterator;
+
+    public:
+        using value_type             = T;
+        using size_type              = std::size_t;
+        using difference_type        = std::ptrdiff_t;
+        using reference              = value_type&;
+        using const_reference        = const value_type&;
+        using pointer                = value_type*;
+        using const_pointer          = const value_type*;
+        using const_iterator         = basic_const_iterator;
+        using iterator               = const_iterator;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+        using reverse_iterator       = const_reverse_iterator;
+
+        //! Open or create a ring file.
+        //!
+        //! An empty or new file is initialized. An existing file must
+        //! have been written by a ring of the same element size and
+        //! capacity; any other file is rejected without modifying it.
+        //!
+        //! @param path the file to store the ring in
+        //! @param sync_interval flush after this many pushes, 0 to never flush automatically
+        //! @throw std::system_error if the file can not be opened or mapped
+        //! @throw std::runtime_error if the file holds an incompatible ring
+        explicit persistent_ring(const std::string& path, size_type sync_interval = 0)
+        : interval(sync_interval)
+        {
+            auto found = size_type(0);
+            if (!map(path, found) || !recover(found))
+            {
+                unmap();
+                throw std::runtime_error("persistent_ring: incompatible or corrupt file " + path);
+            }
+        }
+
+        persistent_ring(const persistent_ring<T, MS>&) = delete;
+
+        //! Move the mapping of other.
+        //!
+        //! The moved from ring has no storage and may only be destroyed,
+        //! assigned to or swapped.
+        persistent_ring(persistent_ring<T, MS>&& other) noexcept
+        {
+            swap(other);
+        }
+
+        ~persistent_ring()
+        {
+            unmap();
+        }
+
+        persistent_ring<T, MS>& operator = (const persistent_ring<T, MS>&) = delete;
+
+        persistent_ring<T, MS>& operator = (persistent_ring<T, MS>&& other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        const_reference front() const noexcept
+        {
+            return element(0);
+        }
+
+        const_reference back() const noexcept
+        {
+            return element(size() - 1);
+        }
+
+        const_reference operator [] (size_type i) const noexcept
+        {
+            return element(i);
+        }
+
+        //! The contents as contiguous segments in logical order.
+        std::array<array_view<T>, 2> segments() const noexcept
+        {
+            auto start = static_cast<size_type>(header->head.load(std::memory_order_relaxed) % MS);
+            auto count = size();
+            auto first = (std::min)(count, MS - start);
+            return {array_view<T>(slots + start, first), array_view<T>(slots, count - first)};
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return const_iterator(this, 0);
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return const_iterator(this, 0);
+        }
+
+        const_iterator end() const noexcept
+        {
+            return const_iterator(this, static_cast<difference_type>(size()));
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return const_iterator(this, static_cast<difference_type>(size()));
+        }
+
+        const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator crbegin() const noexcept
+        {
+            return const_reverse_iterator(cend());
+        }
+
+        const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        const_reverse_iterator crend() const noexcept
+        {
+            return const_reverse_iterator(cbegin());
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        size_type size() const noexcept
+        {
+            return static_cast<size_type>(header->tail.load(std::memory_order_relaxed) - header->head.load(std::memory_order_relaxed));
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Sequence number of the front element.
+        std::uint64_t oldest_sequence() const noexcept
+        {
+            return header->head.load(std::memory_order_relaxed);
+        }
+
+        //! Sequence number the next element pushed will get.
+        std::uint64_t next_sequence() const noexcept
+        {
+            return header->tail.load(std::memory_order_relaxed);
+        }
+
+        //! Append an element, evicting the oldest one when the ring is full.
+        void push_back(const T& value)
+        {
+            auto head = header->head.load(std::memory_order_relaxed);
+            auto tail = header->tail.load(std::memory_order_relaxed);
+            if (tail - head == MS)
+            {
+                // release the slot before overwriting it
+                header->head.store(head + 1, std::memory_order_release);
+            }
+            std::memcpy(static_cast<void*>(slots + tail % MS), &value, sizeof(T));
+            header->tail.store(tail + 1, std::memory_order_release);
+
+            if (interval != 0 && ++unsynced >= interval)
+            {
+                flush();
+            }
+        }
+
+        void pop_front() noexcept
+        {
+            assert(!empty());
+            header->head.fetch_add(1, std::memory_order_release);
+        }
+
+        void clear() noexcept
+        {
+            header->head.store(header->tail.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+
+        //! Write the mapped pages back to the file.
+        //!
+        //! @throw std::system_error if writing fails
+        void flush()
+        {
+            unsynced = 0;
+#ifdef _WIN32
+            if (!FlushViewOfFile(header, 0) || !FlushFileBuffers(file))
+            {
+                throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "persistent_ring");
+            }
+#else
+            if (msync(header, file_size(), MS_SYNC) != 0)
+            {
+                throw std::system_error(errno, std::generic_category(), "persistent_ring");
+            }
+#endif
+        }
+
+        void swap(persistent_ring<T, MS>& other) noexcept
+        {
+            std::swap(header, other.header);
+            std::swap(slots, other.slots);
+            std::swap(interval, other.interval);
+            std::swap(unsynced, other.unsynced);
+#ifdef _WIN32
+            std::swap(file, other.file);
+            std::swap(mapping, other.mapping);
+#endif
+        }
+
+    private:
+        //! The layout of the start of the file.
+        struct file_header
+        {
+            std::uint64_t              magic;
+            std::uint32_t              version;
+            std::uint32_t              element_size;
+            std::uint64_t              capacity;
+            std::uint64_t              checksum;
+            std::atomic<std::uint64_t> head;
+            std::atomic<std::uint64_t> tail;
+        };
+
+        static constexpr std::uint64_t magic_number = 0x474e495258454453; // "STDEXRNG"
+        static constexpr std::uint32_t version      = 1;
+        static constexpr std::size_t   data_offset  = 64;
+
+        static_assert(sizeof(file_header) <= data_offset, "the header must fit before the data");
+
+        file_header* header   = nullptr;
+        T*           slots    = nullptr;
+        size_type    interval = 0;
+        size_type    unsynced = 0;
+#ifdef _WIN32
+        HANDLE       file     = INVALID_HANDLE_VALUE;
+        HANDLE       mapping  = nullptr;
+#endif
+
+        static constexpr size_type file_size() noexcept
+        {
+            return data_offset + MS * sizeof(T);
+        }
+
+        //! FNV-1a over the fields describing the layout.
+        //!
+        //! The magic number is left out, since it is written last.
+        static std::uint64_t checksum(std::uint64_t v, std::uint64_t element_size, std::uint64_t capacity) noexcept
+        {
+            auto hash = std::uint64_t(14695981039346656037u);
+            auto mix  = [&] (std::uint64_t word) {
+                for (auto i = 0; i < 8; i++)
+                {
+                    hash ^= (word >> (i * 8)) & 0xff;
+                    hash *= 1099511628211u;
+                }
+            };
+            mix(v);
+            mix(element_size);
+            mix(capacity);
+            return hash;
+        }
+
+        //! Whether the header is one left by a crash during initialization.
+        //!
+        //! The file was grown with zeros and the magic number was not yet
+        //! written; every other field is still zero or already holds the
+        //! value initialization writes.
+        bool unfinished() const noexcept
+        {
+            auto either = [] (std::uint64_t field, std::uint64_t expected) {
+                return field == 0 || field == expected;
+            };
+            return header->magic == 0 &&
+                   either(header->version, version) &&
+                   either(header->element_size, sizeof(T)) &&
+                   either(header->capacity, MS) &&
+                   either(header->checksum, checksum(version, sizeof(T), MS)) &&
+                   header->head.load(std::memory_order_relaxed) == 0 &&
+                   header->tail.load(std::memory_order_relaxed) == 0;
+        }
+
+        //! Initialize a new file or validate an existing one.
+        //!
+        //! @param found the size of the file before it was mapped
+        bool recover(size_type found) noexcept
+        {
+            if (found == 0 || (found == file_size() && unfinished()))
+            {
+                header->version      = version;
+                header->element_size = static_cast<std::uint32_t>(sizeof(T));
+                header->capacity     = MS;
+                header->checksum     = checksum(version, sizeof(T), MS);
+                new (&header->head) std::atomic<std::uint64_t>(0);
+                new (&header->tail) std::atomic<std::uint64_t>(0);
+                // the magic number is written last, marking the header as valid
+                std::atomic_thread_fence(std::memory_order_release);
+                header->magic = magic_number;
+                return true;
+            }
+
+            auto head = header->head.load(std::memory_order_acquire);
+            auto tail = header->tail.load(std::memory_order_acquire);
+            return header->magic == magic_number &&
+                   header->version == version &&
+                   header->element_size == sizeof(T) &&
+                   header->capacity == MS &&
+                   header->checksum == checksum(header->version, header->element_size, header->capacity) &&
+                   head <= tail && tail - head <= MS;
+        }
+
+        const T& element(size_type i) const noexcept
+        {
+            return slots[(header->head.load(std::memory_order_relaxed) + i) % MS];
+        }
+
+#ifdef _WIN32
+        //! Map the file, growing it only if it is empty.
+        //!
+        //! @param found set to the size of the file before it was mapped
+        //! @return false if the file is too short to be a ring
+        bool map(const std::string& path, size_type& found)
+        {
+            file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                throw std::system_error(static_cast<int>(GetLastError()), std::system_category(), "persistent_ring");
+            }
+
+            LARGE_INTEGER current;
+            if (!GetFileSizeEx(file, &current))
+            {
+                auto error = GetLastError();
+                unmap();
+                throw std::system_error(static_cast<int>(error), std::system_category(), "persistent_ring");
+            }
+            if (current.QuadPart != 0 && static_cast<std::uint64_t>(current.QuadPart) < file_size())
+            {
+                return false;
+            }
+            found = static_cast<size_type>(current.QuadPart);
+
+            // mapping an empty file grows it with zeros
+            auto size64 = static_cast<std::uint64_t>(file_size());
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), nullptr);
+            auto view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, file_size()) : nullptr;
+            if (view == nullptr)
+            {
+                auto error = GetLastError();
+                unmap();
+                throw std::system_error(static_cast<int>(error), std::system_category(), "persistent_ring");
+            }
+
+            header = static_cast<file_header*>(view);
+            slots  = reinterpret_cast<T*>(static_cast<char*>(view) + data_offset);
+            return true;
+        }
+
+        void unmap() noexcept
+        {
+            if (header != nullptr)
+            {
+                UnmapViewOfFile(header);
+                header = nullptr;
+                slots  = nullptr;
+            }
+            if (mapping != nullptr)
+            {
+                CloseHandle(mapping);
+                mapping = nullptr;
+            }
+            if (file != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(file);
+                file = INVALID_HANDLE_VALUE;
+            }
+        }
+#else
+        //! Map the file, growing it only if it is empty.
+        //!
+        //! @param found set to the size of the file before it was mapped
+        //! @return false if the file is too short to be a ring
+        bool map(const std::string& path, size_type& found)
+        {
+            auto fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd == -1)
+            {
+                throw std::system_error(errno, std::generic_category(), "persistent_ring");
+            }
+
+            struct stat info;
+            if (fstat(fd, &info) != 0)
+            {
+                auto error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "persistent_ring");
+            }
+
+            // only an empty file is grown, any other file must be a ring already
+            auto current = static_cast<size_type>(info.st_size);
+            if (current != 0 && current < file_size())
+            {
+                close(fd);
+                return false;
+            }
+            found = current;
+            if (current == 0 && ftruncate(fd, static_cast<off_t>(file_size())) != 0)
+            {
+                auto error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "persistent_ring");
+            }
+
+            auto view  = mmap(nullptr, file_size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            auto error = errno;
+            close(fd);
+            if (view == MAP_FAILED)
+            {
+                throw std::system_error(error, std::generic_category(), "persistent_ring");
+            }
+
+            header = static_cast<file_header*>(view);
+            slots  = reinterpret_cast<T*>(static_cast<char*>(view) + data_offset);
+            return true;
+        }
+
+        void unmap() noexcept
+        {
+            if (header != nullptr)
+            {
+                munmap(header, file_size());
+                header = nullptr;
+                slots  = nullptr;
+            }
+        }
+#endif
+
+        class basic_const_iterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = const T*;
+            using reference         = const T&;
+
+            basic_const_iterator() noexcept = default;
+
+            basic_const_iterator(const persistent_ring<T, MS>* o, difference_type i) noexcept
+            : owner(o), index(i) {}
+
+            reference operator * () const noexcept
+            {
+                return owner->element(static_cast<size_type>(index));
+            }
+
+            pointer operator -> () const noexcept
+            {
+                return &owner->element(static_cast<size_type>(index));
+            }
+
+            reference operator [] (difference_type n) const noexcept
+            {
+                return owner->element(static_cast<size_type>(index + n));
+            }
+
+            basic_const_iterator& operator ++ () noexcept
+            {
+                index++;
+                return *this;
+            }
+
+            basic_const_iterator& operator -- () noexcept
+            {
+                index--;
+                return *this;
+            }
+
+            basic_const_iterator operator ++ (int) noexcept
+            {
+                auto old = *this;
+                index++;
+                return old;
+            }
+
+            basic_const_iterator operator -- (int) noexcept
+            {
+                auto old = *this;
+                index--;
+                return old;
+            }
+
+            basic_const_iterator& operator += (difference_type n) noexcept
+            {
+                index += n;
+                return *this;
+            }
+
+            basic_const_iterator& operator -= (difference_type n) noexcept
+            {
+                index -= n;
+                return *this;
+            }
+
+            friend basic_const_iterator operator + (basic_const_iterator i, difference_type n) noexcept
+            {
+                return i += n;
+            }
+
+            friend basic_const_iterator operator + (difference_type n, basic_const_iterator i) noexcept
+            {
+                return i += n;
+            }
+
+            friend basic_const_iterator operator - (basic_const_iterator i, difference_type n) noexcept
+            {
+                return i -= n;
+            }
+
+            friend difference_type operator - (const basic_const_iterator& a, const basic_const_iterator& b) noexcept
+            {
+                return a.index - b.index;
+            }
+
+            friend bool operator == (const basic_const_iterator& a, const basic_const_iterator& b) noexcept
+            {
+                return a.index == b.index;
+            }
+
+            friend bool operator != (const basic_const_iterator& a, const basic_const_iterator& b) noexcept
+            {
+                return a.index != b.index;
+            }
+
+            friend bool operator < (const basic_const_iterator& a, const basic_const_iterator& b) noexcept
+            {
+                return a.index < b.index;
+            }
+
+            friend bool operator > (const basic_const_iterator& a, const basic_const_iterator& b) noexcept
+            {
+                return a.index > b.index;
+            }
+
+            friend bool operator <= (const basic_const_iterator& a, const basic_const_iterator& b) noexcept
+            {
+                return a.index <= b.index;
+            }
+
+            friend bool operator >= (const basic_const_iterator& a, const basic_const_iterator& b) noexcept
+            {
+                return a.index >= b.index;
+            }
+
+        private:
+            const persistent_ring<T, MS>* owner = nullptr;
+            difference_type               index = 0;
+        };
+    };
+
+    template <typename T, std::size_t MS>
+    auto begin(const persistent_ring<T, MS>& r) noexcept
+    {
+        return r.begin();
+    }
+
+    template <typename T, std::size_t MS>
+    auto cbegin(const persistent_ring<T, MS>& r) noexcept
+    {
+        return r.cbegin();
+    }
+
+    template <typename T, std::size_t MS>
+    auto end(const persistent_ring<T, MS>& r) noexcept
+    {
+        return r.end();
+    }
+
+    template <typename T, std::size_t MS>
+    auto cend(const persistent_ring<T, MS>& r) noexcept
+    {
+        return r.cend();
+    }
+
+    template <typename T, std::size_t MS>
+    void swap(persistent_ring<T, MS>& a, persistent_ring<T, MS>& b) noexcept
+    {
+        a.swap(b);
+    }
+}
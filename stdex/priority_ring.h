@@ -0,0 +1,222 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+namespace stdex
+{
+    //! Priority Ring
+    //!
+    //! A bounded container of MS elements that keeps the elements with the
+    //! highest priority seen, such as the slowest queries, instead of the
+    //! newest. Compare orders by priority like for std::priority_queue, so
+    //! with std::less the largest elements are kept.
+    //!
+    //! The elements are kept in a heap in a fixed array with the lowest
+    //! priority at the root. Once the ring is full, a candidate that does not
+    //! beat the root is rejected in O(1); otherwise it replaces the root in
+    //! O(log MS). On ties the element already held is kept.
+    //!
+    //! T must be default constructible, since the array is filled with
+    //! default constructed elements. Slots that are popped or cleared are
+    //! reset to T(), so the elements they held release their resources.
+    template <typename T, std::size_t MS, typename Compare = std::less<T>>
+    class priority_ring
+    {
+        static_assert(MS > 0, "ring capacity must not be zero");
+
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using const_reference = const value_type&;
+        using const_iterator  = const value_type*;
+
+        explicit priority_ring(Compare c = Compare())
+        : comp(std::move(c)) {}
+
+        priority_ring(std::initializer_list<T> inilst, Compare c = Compare())
+        : comp(std::move(c))
+        {
+            for (const auto& value : inilst)
+            {
+                push(value);
+            }
+        }
+
+        //! The element with the lowest priority, evicted next.
+        const_reference lowest() const noexcept
+        {
+            assert(count > 0);
+            return heap[0];
+        }
+
+        bool empty() const noexcept
+        {
+            return count == 0;
+        }
+
+        size_type size() const noexcept
+        {
+            return count;
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Whether value would be kept by push.
+        bool accepts(const T& value) const
+        {
+            return count < MS || comp(heap[0], value);
+        }
+
+        //! Add a value, evicting the lowest priority element when full.
+        //!
+        //! @return false if the value was rejected
+        bool push(const T& value)
+        {
+            if (!accepts(value))
+            {
+                return false;
+            }
+            place(T(value));
+            return true;
+        }
+
+        bool push(T&& value)
+        {
+            if (!accepts(value))
+            {
+                return false;
+            }
+            place(std::move(value));
+            return true;
+        }
+
+        //! Remove the element with the lowest priority.
+        void pop() noexcept
+        {
+            assert(count > 0);
+            count--;
+            if (count > 0)
+            {
+                heap[0] = std::move(heap[count]);
+                sift_down(0);
+            }
+            heap[count] = T();
+        }
+
+        void clear() noexcept
+        {
+            for (auto i = size_type(0); i < count; i++)
+            {
+                heap[i] = T();
+            }
+            count = 0;
+        }
+
+        //! Iterate the elements in heap order.
+        const_iterator begin() const noexcept
+        {
+            return heap.data();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return heap.data() + count;
+        }
+
+        //! Copy the elements to out, highest priority first.
+        //!
+        //! @return the output iterator past the last element written
+        template <typename OutputIt>
+        OutputIt sorted(OutputIt out) const
+        {
+            auto values = sorted();
+            return std::move(values.begin(), values.end(), out);
+        }
+
+        //! The elements, highest priority first.
+        std::vector<T> sorted() const
+        {
+            auto values = std::vector<T>(begin(), end());
+            std::sort(values.begin(), values.end(), [this] (const T& a, const T& b) { return comp(b, a); });
+            return values;
+        }
+
+    private:
+        std::array<T, MS> heap  = {};
+        size_type         count = 0;
+        Compare           comp;
+
+        void place(T&& value)
+        {
+            if (count < MS)
+            {
+                heap[count] = std::move(value);
+                sift_up(count++);
+            }
+            else
+            {
+                heap[0] = std::move(value);
+                sift_down(0);
+            }
+        }
+
+        void sift_up(size_type i)
+        {
+            auto value = std::move(heap[i]);
+            while (i > 0)
+            {
+                auto parent = (i - 1) / 2;
+                if (!comp(value, heap[parent]))
+                {
+                    break;
+                }
+                heap[i] = std::move(heap[parent]);
+                i = parent;
+            }
+            heap[i] = std::move(value);
+        }
+
+        void sift_down(size_type i)
+        {
+            auto value = std::move(heap[i]);
+            for (;;)
+            {
+                auto child = 2 * i + 1;
+                if (child >= count)
+                {
+                    break;
+                }
+                if (child + 1 < count && comp(heap[child + 1], heap[child]))
+                {
+                    child++;
+                }
+                if (!comp(heap[child], value))
+                {
+                    break;
+                }
+                heap[i] = std::move(heap[child]);
+                i = child;
+            }
+            heap[i] = std::move(value);
+        }
+    };
+}
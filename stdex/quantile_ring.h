@@ -0,0 +1,291 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+
+namespace stdex
+{
+    //! Quantile Ring
+    //!
+    //! A sliding window over the last MS values that answers order
+    //! statistics, such as the median or the 99th percentile, in O(log MS)
+    //! without copying the window.
+    //!
+    //! Next to the window the values are kept in a treap, a randomized
+    //! balanced binary search tree, in which every node knows the size of its
+    //! subtree. The nodes live in a fixed array indexed by the position of
+    //! the value in the stream modulo MS, so the array doubles as the ring
+    //! and no memory is allocated after construction.
+    template <typename T, std::size_t MS, typename Compare = std::less<T>>
+    class quantile_ring
+    {
+        static_assert(MS > 0, "ring capacity must not be zero");
+
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using const_reference = const value_type&;
+
+        explicit quantile_ring(Compare c = Compare())
+        : comp(std::move(c)) {}
+
+        quantile_ring(std::initializer_list<T> inilst, Compare c = Compare())
+        : comp(std::move(c))
+        {
+            for (const auto& value : inilst)
+            {
+                push_back(value);
+            }
+        }
+
+        //! The oldest value.
+        const_reference front() const noexcept
+        {
+            return nodes[(next_seq - count) % MS].value;
+        }
+
+        //! The newest value.
+        const_reference back() const noexcept
+        {
+            return nodes[(next_seq - 1) % MS].value;
+        }
+
+        bool empty() const noexcept
+        {
+            return count == 0;
+        }
+
+        size_type size() const noexcept
+        {
+            return count;
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Add a value, evicting the oldest value when full.
+        void push_back(const T& value)
+        {
+            if (count == capacity())
+            {
+                pop_front();
+            }
+
+            auto seq = next_seq++;
+            auto i   = static_cast<size_type>(seq % MS);
+            auto& n  = nodes[i];
+            n.value    = value;
+            n.seq      = seq;
+            n.priority = hash(seq);
+            n.left     = nil;
+            n.right    = nil;
+            n.size     = 1;
+
+            auto [l, r] = split(root, i);
+            root = merge(merge(l, i), r);
+            count++;
+        }
+
+        //! Remove the oldest value.
+        void pop_front()
+        {
+            assert(count > 0);
+            root = erase(root, static_cast<size_type>((next_seq - count) % MS));
+            count--;
+        }
+
+        void clear() noexcept
+        {
+            root  = nil;
+            count = 0;
+        }
+
+        //! The k-th smallest value, counting from zero.
+        const_reference nth(size_type k) const noexcept
+        {
+            assert(k < count);
+            auto t = root;
+            while (true)
+            {
+                auto ls = size_of(nodes[t].left);
+                if (k < ls)
+                {
+                    t = nodes[t].left;
+                }
+                else if (k == ls)
+                {
+                    return nodes[t].value;
+                }
+                else
+                {
+                    k -= ls + 1;
+                    t  = nodes[t].right;
+                }
+            }
+        }
+
+        //! The q-quantile of the window, using the nearest rank method.
+        //!
+        //! @param q the quantile in [0, 1], for example 0.99 for p99
+        const_reference quantile(double q) const noexcept
+        {
+            assert(count > 0);
+            auto rank = static_cast<size_type>(std::ceil(q * static_cast<double>(count)));
+            return nth(rank == 0 ? 0 : (rank > count ? count : rank) - 1);
+        }
+
+        //! The lower median of the window.
+        const_reference median() const noexcept
+        {
+            return nth((count - 1) / 2);
+        }
+
+        const_reference min() const noexcept
+        {
+            return nth(0);
+        }
+
+        const_reference max() const noexcept
+        {
+            return nth(count - 1);
+        }
+
+    private:
+        static constexpr size_type nil = ~size_type(0);
+
+        struct node
+        {
+            T             value    = T();
+            std::uint64_t seq      = 0;
+            std::uint32_t priority = 0;
+            size_type     left     = nil;
+            size_type     right    = nil;
+            size_type     size     = 0;
+        };
+
+        std::array<node, MS> nodes;
+        size_type            root     = nil;
+        size_type            count    = 0;
+        std::uint64_t        next_seq = 0;
+        Compare              comp;
+
+        //! Priority of a node, derived from its sequence (splitmix64).
+        static std::uint32_t hash(std::uint64_t x) noexcept
+        {
+            x += 0x9e3779b97f4a7c15ull;
+            x  = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+            x  = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+            return static_cast<std::uint32_t>(x ^ (x >> 31));
+        }
+
+        size_type size_of(size_type t) const noexcept
+        {
+            return t == nil ? 0 : nodes[t].size;
+        }
+
+        void update(size_type t) noexcept
+        {
+            nodes[t].size = 1 + size_of(nodes[t].left) + size_of(nodes[t].right);
+        }
+
+        //! Strict order of nodes; equal values are ordered by age.
+        bool less(size_type a, size_type b) const
+        {
+            const auto& na = nodes[a];
+            const auto& nb = nodes[b];
+            if (comp(na.value, nb.value))
+            {
+                return true;
+            }
+            if (comp(nb.value, na.value))
+            {
+                return false;
+            }
+            return na.seq < nb.seq;
+        }
+
+        //! Split t into the nodes ordered before k and the rest.
+        std::pair<size_type, size_type> split(size_type t, size_type k)
+        {
+            if (t == nil)
+            {
+                return {nil, nil};
+            }
+            if (less(t, k))
+            {
+                auto [l, r] = split(nodes[t].right, k);
+                nodes[t].right = l;
+                update(t);
+                return {t, r};
+            }
+            else
+            {
+                auto [l, r] = split(nodes[t].left, k);
+                nodes[t].left = r;
+                update(t);
+                return {l, t};
+            }
+        }
+
+        //! Merge two trees where all nodes of a are ordered before b.
+        size_type merge(size_type a, size_type b) noexcept
+        {
+            if (a == nil)
+            {
+                return b;
+            }
+            if (b == nil)
+            {
+                return a;
+            }
+            if (nodes[a].priority > nodes[b].priority)
+            {
+                nodes[a].right = merge(nodes[a].right, b);
+                update(a);
+                return a;
+            }
+            else
+            {
+                nodes[b].left = merge(a, nodes[b].left);
+                update(b);
+                return b;
+            }
+        }
+
+        size_type erase(size_type t, size_type k)
+        {
+            assert(t != nil);
+            if (t == k)
+            {
+                return merge(nodes[t].left, nodes[t].right);
+            }
+            if (less(k, t))
+            {
+                nodes[t].left = erase(nodes[t].left, k);
+            }
+            else
+            {
+                nodes[t].right = erase(nodes[t].right, k);
+            }
+            update(t);
+            return t;
+        }
+    };
+}
@@ -0,0 +1,228 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <stdexcept>
+
+#include "array_view.h"
+
+namespace stdex
+{
+    //! Record Ring
+    //!
+    //! A ring of MS bytes holding variable length records, such as log
+    //! lines or messages, without allocating memory per record.
+    //!
+    //! Every record is stored as a frame: a 32 bit length followed by the
+    //! payload, padded to four bytes. A record never wraps around the end
+    //! of the buffer; when it does not fit before the end, the remaining
+    //! bytes are marked as padding and the record starts at the beginning.
+    //! When the buffer is full, whole records are evicted from the front.
+    //!
+    //! Records are written in place with reserve and commit and read in
+    //! place with peek and release. The views returned by reserve and peek
+    //! are invalidated by the next reserve.
+    template <std::size_t MS>
+    class record_ring
+    {
+        static_assert(MS % 4 == 0, "record ring capacity must be a multiple of four bytes");
+        static_assert(MS >= 8, "record ring capacity must hold at least one frame");
+        static_assert(MS <= UINT32_MAX, "record ring capacity must fit the 32 bit frame header");
+
+    public:
+        using size_type = std::size_t;
+
+        record_ring() noexcept = default;
+
+        //! Number of records.
+        size_type size() const noexcept
+        {
+            return records;
+        }
+
+        bool empty() const noexcept
+        {
+            return records == 0;
+        }
+
+        //! Size of the buffer in bytes.
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Number of bytes used by frames and padding.
+        size_type bytes_used() const noexcept
+        {
+            return static_cast<size_type>(tail - head);
+        }
+
+        //! The largest record that fits into the ring.
+        static constexpr size_type max_record_size() noexcept
+        {
+            return MS - header_size;
+        }
+
+        //! Number of records evicted to make room for new ones.
+        std::uint64_t dropped() const noexcept
+        {
+            return evicted;
+        }
+
+        //! Reserve space for a record of len bytes at the back.
+        //!
+        //! Old records are evicted until the record fits. The record is
+        //! added by commit; reserving again without commit discards it.
+        //!
+        //! @throw std::length_error if len exceeds max_record_size
+        array_span<char> reserve(size_type len)
+        {
+            if (len > max_record_size())
+            {
+                throw std::length_error("record_ring: record too large");
+            }
+
+            auto frame = frame_size(len);
+            auto pad   = padding(frame);
+            while (MS - bytes_used() < pad + frame)
+            {
+                if (records == 0)
+                {
+                    // only padding left, start over at the beginning
+                    head = tail = 0;
+                    pad  = 0;
+                    break;
+                }
+                evict_front();
+            }
+
+            if (pad != 0)
+            {
+                write_header(tail, padding_marker);
+                tail += pad;
+            }
+            reserved = len;
+            return array_span<char>(buffer.data() + offset(tail) + header_size, len);
+        }
+
+        //! Add the reserved record.
+        void commit() noexcept
+        {
+            commit(reserved);
+        }
+
+        //! Add the first len bytes of the reserved record.
+        //!
+        //! This allows to reserve for the largest record possible and only
+        //! keep what was written.
+        void commit(size_type len) noexcept
+        {
+            assert(len <= reserved);
+            write_header(tail, static_cast<std::uint32_t>(len));
+            tail    += frame_size(len);
+            reserved = 0;
+            records++;
+        }
+
+        //! Copy a record to the back.
+        void push(const array_view<char>& record)
+        {
+            auto span = reserve(record.size());
+            if (!record.empty())
+            {
+                std::memcpy(span.data(), record.data(), record.size());
+            }
+            commit();
+        }
+
+        //! The front record.
+        array_view<char> peek() const noexcept
+        {
+            assert(!empty());
+            auto pos = skip_padding(head);
+            auto len = read_header(pos);
+            return array_view<char>(buffer.data() + offset(pos) + header_size, len);
+        }
+
+        //! Remove the front record.
+        void release() noexcept
+        {
+            assert(!empty());
+            head = skip_padding(head);
+            head += frame_size(read_header(head));
+            records--;
+        }
+
+        void clear() noexcept
+        {
+            head     = 0;
+            tail     = 0;
+            reserved = 0;
+            records  = 0;
+        }
+
+    private:
+        static constexpr size_type     header_size    = sizeof(std::uint32_t);
+        static constexpr std::uint32_t padding_marker = UINT32_MAX;
+
+        alignas(std::uint32_t) std::array<char, MS> buffer;
+        // head and tail are byte positions that only grow
+        std::uint64_t head     = 0;
+        std::uint64_t tail     = 0;
+        size_type     reserved = 0;
+        size_type     records  = 0;
+        std::uint64_t evicted  = 0;
+
+        static constexpr size_type frame_size(size_type len) noexcept
+        {
+            return (header_size + len + 3) & ~size_type(3);
+        }
+
+        static constexpr size_type offset(std::uint64_t pos) noexcept
+        {
+            return static_cast<size_type>(pos % MS);
+        }
+
+        //! Bytes to skip at the tail so that the frame does not wrap.
+        size_type padding(size_type frame) const noexcept
+        {
+            auto o = offset(tail);
+            return o + frame > MS ? MS - o : 0;
+        }
+
+        std::uint32_t read_header(std::uint64_t pos) const noexcept
+        {
+            std::uint32_t value;
+            std::memcpy(&value, buffer.data() + offset(pos), sizeof(value));
+            return value;
+        }
+
+        void write_header(std::uint64_t pos, std::uint32_t value) noexcept
+        {
+            std::memcpy(buffer.data() + offset(pos), &value, sizeof(value));
+        }
+
+        std::uint64_t skip_padding(std::uint64_t pos) const noexcept
+        {
+            return read_header(pos) == padding_marker ? pos + (MS - offset(pos)) : pos;
+        }
+
+        void evict_front() noexcept
+        {
+            release();
+            evicted++;
+        }
+    };
+}
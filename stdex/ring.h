@@ -9,17 +9,87 @@
 
 #pragma once
 
+#include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <iterator>
 #include <utility>
 #include <deque>
+#include <memory>
+#include <memory_resource>
+#include <array>
+#include <algorithm>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
 
 #include "iterator.h"
+#include "array_view.h"
 
 namespace stdex
 {
-    template <typename T, std::size_t MS, typename Container = std::deque<T>>
+    //! Inline Storage
+    //!
+    //! Using inline_storage as the container of a ring keeps all MS elements
+    //! inside the ring object. The elements are addressed through a head index
+    //! and a size, so pushing onto a full ring overwrites the oldest slot
+    //! without touching the heap.
+    struct inline_storage {};
+
+    //! Whether Container stores its elements contiguously, detected by a
+    //! data() member like std::vector has.
+    template <typename Container, typename = void>
+    struct is_contiguous_container : std::false_type {};
+
+    template <typename Container>
+    struct is_contiguous_container<Container, std::void_t<decltype(std::declval<const Container&>().data())>> : std::true_type {};
+
+    template <typename Container>
+    constexpr bool is_contiguous_container_v = is_contiguous_container<Container>::value;
+
+    //! How many elements Container keeps contiguous in each of its blocks,
+    //! or 1 when that is not known.
+    //!
+    //! The value is used as a lower bound, so that a ring can search for
+    //! the end of a block instead of testing every element. The sizes for
+    //! std::deque follow the block layout of the standard libraries.
+    template <typename Container>
+    struct container_block_size : std::integral_constant<std::size_t, 1> {};
+
+    template <typename T, typename Alloc>
+    struct container_block_size<std::deque<T, Alloc>> : std::integral_constant<std::size_t,
+#if defined(_MSVC_STL_VERSION)
+        sizeof(T) <= 1 ? 16 : sizeof(T) <= 2 ? 8 : sizeof(T) <= 4 ? 4 : sizeof(T) <= 8 ? 2 : 1
+#elif defined(_LIBCPP_VERSION)
+        sizeof(T) < 256 ? 4096 / sizeof(T) : 16
+#elif defined(__GLIBCXX__)
+        sizeof(T) < 512 ? 512 / sizeof(T) : 1
+#else
+        1
+#endif
+        > {};
+
+    template <typename Container>
+    constexpr std::size_t container_block_size_v = container_block_size<Container>::value;
+
+    //! Ring
+    //!
+    //! A sequence of at most MS elements on top of Container; pushing onto
+    //! a full ring evicts the element at the other end.
+    //!
+    //! Elements pushed to the back get increasing sequence numbers, so a
+    //! reader can resume where it left off, see oldest_sequence. Pushing to
+    //! the front, inserting, prepend and pop_back end the numbering until
+    //! the ring is cleared, instead of handing out shifted numbers.
+    //!
+    //! With Slack the container may grow to MS + Slack elements before
+    //! the oldest ones are evicted in a single erase. The stale elements
+    //! stay hidden, so iteration and size only ever expose the newest MS
+    //! elements. This trades memory for far fewer erase calls. Operations
+    //! other than pushing to the back drop the stale elements first, and
+    //! begin has to skip them, which is O(Slack) for a list.
+    template <typename T, std::size_t MS, typename Container = std::deque<T>, std::size_t Slack = 0>
     class ring
     {
     public:
@@ -45,7 +115,7 @@ namespace stdex
         }
 
         explicit ring(Container&& cont)
-        : container(cont) 
+        : container(std::move(cont)) 
         {
             prune_back();
         }
@@ -75,38 +145,56 @@ namespace stdex
         }
 
         template <typename Alloc>
-        ring(const Container&& cont, const Alloc& alloc)
-        : container(cont, alloc)
+        ring(Container&& cont, const Alloc& alloc)
+        : container(std::move(cont), alloc)
+        {
+            prune_back();
+        }
+
+        template <typename Alloc>
+        ring(std::initializer_list<T> inilst, const Alloc& alloc)
+        : container(inilst, alloc)
         {
             prune_back();
         }
 
         template <typename InputIt, typename Alloc>
         ring(InputIt first, InputIt last, const Alloc& alloc)
-        : ring(first, last) 
+        : container(first, last, alloc) 
         {
             prune_back();
         }
 
-        ring(const ring<T, MS, Container>& other) noexcept = default;
-        ring(ring<T, MS, Container>&& other) noexcept = default;
+        ring(const ring<T, MS, Container, Slack>& other) noexcept = default;
+        ring(ring<T, MS, Container, Slack>&& other) noexcept = default;
 
         template <typename Alloc >
-        ring(const ring<T, MS, Container>& other, const Alloc& alloc)
-        : container(other.container, alloc) {}
+        ring(const ring<T, MS, Container, Slack>& other, const Alloc& alloc)
+        : container(other.container, alloc), first_seq(other.first_seq), numbered(other.numbered) {}
 
         template <typename Alloc>
-        ring(ring<T, MS, Container>&& other, const Alloc& alloc)
-        : container(std::move(other.container), alloc) {}
+        ring(ring<T, MS, Container, Slack>&& other, const Alloc& alloc)
+        : container(std::move(other.container), alloc), first_seq(other.first_seq), numbered(other.numbered) {}
 
         ~ring() = default;
 
-        ring<T, MS, Container>& operator = (const ring<T, MS, Container>& other) noexcept = default;
-        ring<T, MS, Container>& operator = (ring<T, MS, Container>&& other) noexcept = default;
+        ring<T, MS, Container, Slack>& operator = (const ring<T, MS, Container, Slack>& other) noexcept = default;
+        ring<T, MS, Container, Slack>& operator = (ring<T, MS, Container, Slack>&& other) noexcept = default;
+
+        //! The allocator of the underlying container.
+        auto get_allocator() const noexcept
+        {
+            return container.get_allocator();
+        }
+
+        reference front() noexcept
+        {
+            return *begin();
+        }
 
         const_reference front() const noexcept
         {
-            return container.front();
+            return *begin();
         }
 
         reference back() noexcept
@@ -121,22 +209,99 @@ namespace stdex
 
         const_pointer data() const noexcept
         {
-            return container.data();
+            static_assert(is_contiguous_container_v<Container>, "data requires a contiguous container");
+            if constexpr (is_contiguous_container_v<Container>)
+            {
+                return container.data() + stale();
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+
+        //! The contents as contiguous segments in logical order.
+        //!
+        //! Only available for contiguous containers, where the second segment
+        //! is always empty. A deque keeps its elements in many small blocks,
+        //! so it cannot be described by two segments; use visit_segments and
+        //! fill_segments there, or inline_storage for at most two segments.
+        std::array<array_view<T>, 2> segments() const noexcept
+        {
+            static_assert(is_contiguous_container_v<Container>, "segments requires a contiguous container, use visit_segments instead");
+            if constexpr (is_contiguous_container_v<Container>)
+            {
+                return {array_view<T>(data(), size()), array_view<T>()};
+            }
+            else
+            {
+                return {};
+            }
+        }
+
+        //! Pass the contents to fn as contiguous runs in logical order.
+        //!
+        //! fn is called with array_view<T> over runs of elements that are
+        //! contiguous in the container, like consume, but nothing is
+        //! released. A vector backend yields one run, a deque backend one
+        //! run per block.
+        template <typename Fn>
+        void visit_segments(Fn&& fn) const
+        {
+            for_each_run<array_view<T>>(begin(), end(), fn);
+        }
+
+        //! Fill the free room after the back in place.
+        //!
+        //! The capacity() - size() free elements are appended value
+        //! initialized and passed to fn as array_span<T> over runs that are
+        //! contiguous in the container, like visit_segments. fn returns how
+        //! many elements of the run it wrote; a run that is not written
+        //! completely ends the fill. The unwritten elements are removed
+        //! again, so the result is the same as appending the written ones.
+        //!
+        //! @return the number of elements added
+        template <typename Fn>
+        size_type fill_segments(Fn&& fn)
+        {
+            auto room = capacity() - size();
+            if (room == 0)
+            {
+                return 0;
+            }
+
+            auto old_size = container.size();
+            container.resize(old_size + room);
+
+            auto filled = size_type(0);
+            auto done   = false;
+            auto fill_run = [&] (array_span<T> run) {
+                if (!done)
+                {
+                    auto n = std::min(static_cast<size_type>(fn(run)), run.size());
+                    filled += n;
+                    done    = n < run.size();
+                }
+            };
+            for_each_run<array_span<T>>(inline_advance(std::begin(container), old_size), std::end(container), fill_run);
+
+            container.erase(inline_advance(std::begin(container), old_size + filled), std::end(container));
+            return filled;
         }
 
         iterator begin() noexcept
         {
-            return container.begin();
+            return inline_advance(container.begin(), stale());
         }
 
         const_iterator begin() const noexcept
         {
-            return container.begin();
+            return inline_advance(container.begin(), stale());
         }
 
         const_iterator cbegin() const noexcept
         {
-            return container.cbegin();
+            return inline_advance(container.cbegin(), stale());
         }
 
         iterator end() noexcept
@@ -171,17 +336,17 @@ namespace stdex
 
         reverse_iterator rend() noexcept
         {
-            return container.rend();
+            return reverse_iterator(begin());
         }
 
         const_reverse_iterator rend() const noexcept
         {
-            return container.rend();
+            return const_reverse_iterator(begin());
         }
 
         const_reverse_iterator crend() const noexcept
         {
-            return container.crend();
+            return const_reverse_iterator(cbegin());
         }
 
         bool empty() const noexcept
@@ -191,7 +356,7 @@ namespace stdex
 
         size_type size() const noexcept
         {
-            return container.size();
+            return container.size() - stale();
         }
 
         constexpr size_type capacity() const noexcept
@@ -199,16 +364,28 @@ namespace stdex
             return MS;
         }
 
+        //! How many stale elements may be kept before they are evicted.
+        constexpr size_type slack() const noexcept
+        {
+            return Slack;
+        }
+
         void push_front(const T& value) noexcept
         {
+            auto next = next_sequence();
+            drop_stale();
             container.push_front(value);
             prune_back();
+            end_numbering(next);
         }
 
         void push_front(T&& value) noexcept
         {
-            container.push_front(value);
+            auto next = next_sequence();
+            drop_stale();
+            container.push_front(std::move(value));
             prune_back();
+            end_numbering(next);
         }
 
         void push_back(const T& value) noexcept
@@ -219,85 +396,440 @@ namespace stdex
 
         void push_back(T&& value) noexcept
         {
-            container.push_back(value);
+            container.push_back(std::move(value));
             prune_front();
         }
 
         template <typename... Args>
         void emplace_front(Args&&... args)
         {
-            container.emplace_front(args...);
+            auto next = next_sequence();
+            drop_stale();
+            container.emplace_front(std::forward<Args>(args)...);
             prune_back();
+            end_numbering(next);
         }
 
         template <typename... Args>
         void emplace_back(Args&&... args)
         {
-            container.emplace_back(args...);
+            container.emplace_back(std::forward<Args>(args)...);
             prune_front();
         }
 
         void pop_front() noexcept
         {
-            container.pop_front();
+            erase_front(stale() + 1);
         }
 
         void pop_back() noexcept
         {
+            auto next = next_sequence();
+            drop_stale();
             container.pop_back();
+            end_numbering(next);
         }
 
         iterator insert(iterator pos, const T& value)
         {
+            return insert(const_iterator(pos), value);
+        }
+
+        iterator insert(const_iterator pos, const T& value)
+        {
+            auto next = next_sequence();
+            pos = drop_stale(pos);
+            if (culled(pos))
+            {
+                return end();
+            }
             auto i = container.insert(pos, value);
             prune_back();
+            end_numbering(next);
             return i;
         }
 
-        iterator insert(const_iterator pos, const T& value)
+        iterator insert(iterator pos, T&& value)
         {
-            auto i = container.insert(pos, value);
+            return insert(const_iterator(pos), std::move(value));
+        }
+
+        iterator insert(const_iterator pos, T&& value)
+        {
+            auto next = next_sequence();
+            pos = drop_stale(pos);
+            if (culled(pos))
+            {
+                return end();
+            }
+            auto i = container.insert(pos, std::move(value));
             prune_back();
+            end_numbering(next);
             return i;
         }
 
         template< class InputIt >
         iterator insert(const_iterator pos, InputIt first, InputIt last )
         {
+            auto next = next_sequence();
+            pos = drop_stale(pos);
+            if (first == last || culled(pos))
+            {
+                // nothing is stored, so the numbering goes on
+                return container.insert(pos, first, first);
+            }
             auto i = container.insert(pos, first, last);
             prune_back();
+            end_numbering(next);
             return i;
         }
 
         template <typename... Args>
         iterator emplace(const_iterator pos, Args&&... args)
         {
-            auto i = container.emplace(pos, std::forward<Args...>(args...));
+            auto next = next_sequence();
+            pos = drop_stale(pos);
+            if (culled(pos))
+            {
+                return end();
+            }
+            auto i = container.emplace(pos, std::forward<Args>(args)...);
             prune_back();
+            end_numbering(next);
             return i;
         }
 
+        //! Push a range of elements to the back.
+        //!
+        //! The result is the same as calling push_back for each element, but
+        //! only the last MS elements of the range are copied and the old
+        //! elements are evicted with a single erase.
+        template <typename InputIt>
+        void append(InputIt first, InputIt last)
+        {
+            using category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>)
+            {
+                auto n = static_cast<size_type>(std::distance(first, last));
+                if (container.size() + n > capacity())
+                {
+                    first_seq += container.size() + n - capacity();
+                }
+                if (n >= capacity())
+                {
+                    std::advance(first, n - capacity());
+                    container.clear();
+                }
+                else if (container.size() + n > capacity())
+                {
+                    auto erase_begin = std::begin(container);
+                    auto erase_end   = inline_advance(erase_begin, container.size() + n - capacity());
+                    container.erase(erase_begin, erase_end);
+                }
+                container.insert(std::end(container), first, last);
+            }
+            else
+            {
+                for (; first != last; ++first)
+                {
+                    push_back(*first);
+                }
+            }
+        }
+
+        //! Push a range of elements to the back.
+        void append(const array_view<T>& values)
+        {
+            append(values.begin(), values.end());
+        }
+
+        //! Push a range of elements to the front.
+        //!
+        //! The result is the same as calling push_front for each element, so
+        //! the last element of the range ends up at the front. Only the last
+        //! MS elements of the range are copied and the old elements are
+        //! evicted with a single erase.
+        template <typename InputIt>
+        void prepend(InputIt first, InputIt last)
+        {
+            using category = typename std::iterator_traits<InputIt>::iterator_category;
+            if (first == last)
+            {
+                // nothing is stored, so the numbering goes on
+                return;
+            }
+            if constexpr (std::is_base_of_v<std::bidirectional_iterator_tag, category>)
+            {
+                auto next = next_sequence();
+                drop_stale();
+                auto n = static_cast<size_type>(std::distance(first, last));
+                if (n >= capacity())
+                {
+                    std::advance(first, n - capacity());
+                    container.clear();
+                }
+                else if (container.size() + n > capacity())
+                {
+                    auto erase_begin = inline_advance(std::begin(container), capacity() - n);
+                    container.erase(erase_begin, std::end(container));
+                }
+                container.insert(std::begin(container), std::make_reverse_iterator(last), std::make_reverse_iterator(first));
+                end_numbering(next);
+            }
+            else
+            {
+                for (; first != last; ++first)
+                {
+                    push_front(*first);
+                }
+            }
+        }
+
+        //! Push a range of elements to the front.
+        void prepend(const array_view<T>& values)
+        {
+            prepend(values.begin(), values.end());
+        }
+
+        //! Move up to n elements from the front to out.
+        //!
+        //! The elements are released with a single erase.
+        //!
+        //! @return the output iterator past the last element written
+        template <typename OutputIt>
+        OutputIt pop_front_n(size_type n, OutputIt out)
+        {
+            n = std::min(n, size());
+            auto move_begin = begin();
+            auto move_end   = inline_advance(move_begin, n);
+            out = std::move(move_begin, move_end, out);
+            erase_front(stale() + n);
+            return out;
+        }
+
+        //! Move all elements to the back of c and clear the ring.
+        //!
+        //! @return the number of elements moved
+        template <typename C>
+        size_type drain_into(C& c)
+        {
+            auto n = size();
+            c.insert(std::end(c), std::make_move_iterator(begin()), std::make_move_iterator(end()));
+            clear();
+            return n;
+        }
+
+        //! Pass up to n elements from the front to fn and release them.
+        //!
+        //! fn is called with array_view<T> over runs of elements that are
+        //! contiguous in the container, so nothing is copied. A vector backend
+        //! yields one run, a deque backend one run per block.
+        //!
+        //! @return the number of elements consumed
+        template <typename Fn>
+        size_type consume(size_type n, Fn&& fn)
+        {
+            n = std::min(n, size());
+            auto consume_begin = cbegin();
+            for_each_run<array_view<T>>(consume_begin, inline_advance(consume_begin, n), fn);
+            erase_front(stale() + n);
+            return n;
+        }
+
         void clear() noexcept
         {
+            first_seq += container.size();
             container.clear();
+            numbered = true;
         }
 
-        void swap(ring<T, MS, Container>& other) noexcept
+        void swap(ring<T, MS, Container, Slack>& other) noexcept
         {
             std::swap(container, other.container);
+            std::swap(first_seq, other.first_seq);
+            std::swap(numbered, other.numbered);
+        }
+
+        //! Sequence number of the front element.
+        //!
+        //! Every element pushed to the back gets the next sequence number,
+        //! so a reader can remember where it left off. When the reader's
+        //! position is smaller than oldest_sequence, the elements in between
+        //! were evicted.
+        //!
+        //! Numbers are never reused and next_sequence never decreases.
+        //! Pushing to the front, inserting in the middle, prepend and
+        //! pop_back would shift or reuse the numbers of the held elements,
+        //! so they end the numbering instead: sequenced turns false,
+        //! at_sequence finds nothing and oldest_sequence equals
+        //! next_sequence. After clear the elements pushed to the back are
+        //! numbered again, following every number handed out so far.
+        std::uint64_t oldest_sequence() const noexcept
+        {
+            return numbered ? first_seq + stale() : next_sequence();
+        }
+
+        //! Sequence number the next element pushed to the back will get.
+        std::uint64_t next_sequence() const noexcept
+        {
+            return first_seq + container.size();
+        }
+
+        //! Whether the elements can be looked up by sequence number.
+        //!
+        //! See oldest_sequence for the mutations that end the numbering.
+        bool sequenced() const noexcept
+        {
+            return numbered;
+        }
+
+        //! The element with sequence number n.
+        //!
+        //! @return nullptr if the element was evicted, is not pushed yet or
+        //! the ring is not sequenced
+        pointer at_sequence(std::uint64_t n) noexcept
+        {
+            auto i = n - oldest_sequence();
+            return numbered && i < size() ? &*inline_advance(begin(), i) : nullptr;
+        }
+
+        //! The element with sequence number n.
+        //!
+        //! @return nullptr if the element was evicted, is not pushed yet or
+        //! the ring is not sequenced
+        const_pointer at_sequence(std::uint64_t n) const noexcept
+        {
+            auto i = n - oldest_sequence();
+            return numbered && i < size() ? &*inline_advance(begin(), i) : nullptr;
         }
 
     private:
         container_type container;
+        std::uint64_t  first_seq = 0;
+        bool           numbered  = true;
+
+        //! Number of evicted elements still in the container.
+        size_type stale() const noexcept
+        {
+            if constexpr (Slack == 0)
+            {
+                return 0;
+            }
+            else
+            {
+                return container.size() > capacity() ? container.size() - capacity() : 0;
+            }
+        }
+
+        void erase_front(size_type n) noexcept
+        {
+            auto erase_begin = std::begin(container);
+            auto erase_end   = inline_advance(erase_begin, n);
+            container.erase(erase_begin, erase_end);
+            first_seq += n;
+        }
+
+        //! Pass [first, last) to fn as View over runs of contiguous elements.
+        //!
+        //! A window of container_block_size elements holds at most one block
+        //! boundary, so the end of each run is found by bisection instead of
+        //! testing every element.
+        template <typename View, typename It, typename Fn>
+        static void for_each_run(It first, It last, Fn& fn)
+        {
+            using category = typename std::iterator_traits<It>::iterator_category;
+            constexpr auto window = static_cast<difference_type>(container_block_size_v<Container>);
+
+            if constexpr (is_contiguous_container_v<Container>)
+            {
+                if (first != last)
+                {
+                    fn(View(&*first, static_cast<size_type>(std::distance(first, last))));
+                }
+            }
+            else if constexpr (window > 1 && std::is_base_of_v<std::random_access_iterator_tag, category>)
+            {
+                while (first != last)
+                {
+                    // [0, lo) is contiguous and the run ends in [lo, hi]
+                    auto run_begin = &*first;
+                    auto lo        = difference_type(1);
+                    auto hi        = std::min(static_cast<difference_type>(last - first), window);
+                    while (lo < hi)
+                    {
+                        auto mid = lo + (hi - lo) / 2;
+                        if (&*(first + mid) == run_begin + mid)
+                        {
+                            lo = mid + 1;
+                        }
+                        else
+                        {
+                            hi = mid;
+                        }
+                    }
+                    fn(View(run_begin, static_cast<size_type>(lo)));
+                    first += lo;
+                }
+            }
+            else
+            {
+                auto run_begin = first;
+                auto run_size  = size_type(0);
+                for (auto i = first; i != last; ++i)
+                {
+                    if (run_size != 0 && &*i != &*run_begin + run_size)
+                    {
+                        fn(View(&*run_begin, run_size));
+                        run_begin = i;
+                        run_size  = 0;
+                    }
+                    run_size++;
+                }
+                if (run_size != 0)
+                {
+                    fn(View(&*run_begin, run_size));
+                }
+            }
+        }
+
+        //! Whether an element inserted at pos would be evicted right away.
+        bool culled(const_iterator pos) const noexcept
+        {
+            return static_cast<size_type>(std::distance(container.cbegin(), pos)) >= capacity();
+        }
+
+        //! Stop numbering the elements, next_sequence stays at next.
+        void end_numbering(std::uint64_t next) noexcept
+        {
+            first_seq = next - container.size();
+            numbered  = false;
+        }
+
+        void drop_stale() noexcept
+        {
+            if (stale() != 0)
+            {
+                erase_front(stale());
+            }
+        }
+
+        //! Drop the stale elements and find pos again.
+        const_iterator drop_stale(const_iterator pos) noexcept
+        {
+            if (stale() == 0)
+            {
+                return pos;
+            }
+            auto i = std::distance(cbegin(), pos);
+            drop_stale();
+            return inline_advance(container.cbegin(), i);
+        }
 
         void prune_front() noexcept
         {
-            if (container.size() > capacity())
+            if (container.size() > capacity() + Slack)
             {
-                auto diff = container.size() - capacity();
-                auto erase_begin = std::begin(container);
-                auto erase_end   = inline_advance(erase_begin, diff);
-                container.erase(erase_begin, erase_end);
+                erase_front(container.size() - capacity());
             }
         }
 
@@ -312,9 +844,901 @@ namespace stdex
         }
     };
 
-    template <typename T, std::size_t MS, typename Container>
-    void swap(ring<T, MS, Container>& a, ring<T, MS, Container>& b) noexcept
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto begin(ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.begin();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto begin(const ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.begin();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto cbegin(const ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.cbegin();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto end(ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.end();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto end(const ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.end();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto cend(const ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.cend();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto rbegin(ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.rbegin();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto rbegin(const ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.rbegin();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto crbegin(const ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.crbegin();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto rend(ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.rend();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto rend(const ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.rend();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    auto crend(const ring<T, MS, Container, Slack>& r) noexcept
+    {
+        return r.crend();
+    }
+
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack>
+    void swap(ring<T, MS, Container, Slack>& a, ring<T, MS, Container, Slack>& b) noexcept
     {
         a.swap(b);
     }
+
+    template <typename T, std::size_t MS>
+    class ring<T, MS, inline_storage>
+    {
+        static_assert(MS > 0, "ring capacity must not be zero");
+
+        template <bool Const>
+        class basic_iterator;
+
+    public:
+        using container_type         = inline_storage;
+        using value_type             = T;
+        using size_type              = std::size_t;
+        using difference_type        = std::ptrdiff_t;
+        using reference              = value_type&;
+        using const_reference        = const value_type&;
+        using pointer                = value_type*;
+        using const_pointer          = const value_type*;
+        using iterator               = basic_iterator<false>;
+        using const_iterator         = basic_iterator<true>;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        ring() noexcept = default;
+
+        explicit ring(std::initializer_list<T> inilst)
+        : ring(std::begin(inilst), std::end(inilst)) {}
+
+        template <typename InputIt>
+        ring(InputIt first, InputIt last)
+        {
+            for (; first != last && count < capacity(); ++first)
+            {
+                emplace_back(*first);
+            }
+        }
+
+        ring(const ring<T, MS, inline_storage>& other) noexcept(std::is_nothrow_copy_constructible_v<T>)
+        {
+            for (const auto& value : other)
+            {
+                emplace_back(value);
+            }
+            first_seq = other.first_seq;
+            numbered  = other.numbered;
+        }
+
+        ring(ring<T, MS, inline_storage>&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            for (auto& value : other)
+            {
+                emplace_back(std::move(value));
+            }
+            first_seq = other.first_seq;
+            numbered  = other.numbered;
+            other.clear();
+        }
+
+        ~ring()
+        {
+            clear();
+        }
+
+        ring<T, MS, inline_storage>& operator = (const ring<T, MS, inline_storage>& other) noexcept(std::is_nothrow_copy_constructible_v<T>)
+        {
+            if (this != &other)
+            {
+                clear();
+                for (const auto& value : other)
+                {
+                    emplace_back(value);
+                }
+                first_seq = other.first_seq;
+                numbered  = other.numbered;
+            }
+            return *this;
+        }
+
+        ring<T, MS, inline_storage>& operator = (ring<T, MS, inline_storage>&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            if (this != &other)
+            {
+                clear();
+                for (auto& value : other)
+                {
+                    emplace_back(std::move(value));
+                }
+                first_seq = other.first_seq;
+                numbered  = other.numbered;
+                other.clear();
+            }
+            return *this;
+        }
+
+        reference front() noexcept
+        {
+            return element(0);
+        }
+
+        const_reference front() const noexcept
+        {
+            return element(0);
+        }
+
+        reference back() noexcept
+        {
+            return element(count - 1);
+        }
+
+        const_reference back() const noexcept
+        {
+            return element(count - 1);
+        }
+
+        //! The contents as contiguous segments in logical order.
+        //!
+        //! The second segment is only non empty when the contents wrap
+        //! around the end of the storage.
+        std::array<array_view<T>, 2> segments() const noexcept
+        {
+            auto first = std::min(count, MS - head);
+            return {array_view<T>(slot_pointer(head), first), array_view<T>(slot_pointer(0), count - first)};
+        }
+
+        //! Pass the non empty segments to fn in logical order.
+        template <typename Fn>
+        void visit_segments(Fn&& fn) const
+        {
+            for (const auto& seg : segments())
+            {
+                if (!seg.empty())
+                {
+                    fn(seg);
+                }
+            }
+        }
+
+        //! The free slots after the back as contiguous segments.
+        //!
+        //! The slots can be filled in place and are added to the ring with
+        //! commit. This requires T to be trivially copyable, since the slots
+        //! are raw storage.
+        std::array<array_span<T>, 2> free_segments() noexcept
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "free_segments requires a trivially copyable type");
+            auto tail  = wrap(head + count);
+            auto free  = MS - count;
+            auto first = std::min(free, MS - tail);
+            return {array_span<T>(slot_pointer(tail), first), array_span<T>(slot_pointer(0), free - first)};
+        }
+
+        //! Add n elements written through free_segments to the back.
+        void commit(size_type n) noexcept
+        {
+            assert(count + n <= MS);
+            count += n;
+        }
+
+        //! Fill the free room after the back in place.
+        //!
+        //! Like the generic ring, fn is called with the free segments and
+        //! returns how many elements of a segment it wrote; a segment that
+        //! is not written completely ends the fill. The written elements
+        //! are committed.
+        //!
+        //! @return the number of elements added
+        template <typename Fn>
+        size_type fill_segments(Fn&& fn)
+        {
+            auto filled = size_type(0);
+            for (auto& seg : free_segments())
+            {
+                if (seg.empty())
+                {
+                    break;
+                }
+                auto n = std::min(static_cast<size_type>(fn(seg)), seg.size());
+                filled += n;
+                if (n < seg.size())
+                {
+                    break;
+                }
+            }
+            commit(filled);
+            return filled;
+        }
+
+        iterator begin() noexcept
+        {
+            return iterator(this, 0);
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return const_iterator(this, 0);
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return const_iterator(this, 0);
+        }
+
+        iterator end() noexcept
+        {
+            return iterator(this, count);
+        }
+
+        const_iterator end() const noexcept
+        {
+            return const_iterator(this, count);
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return const_iterator(this, count);
+        }
+
+        reverse_iterator rbegin() noexcept
+        {
+            return reverse_iterator(end());
+        }
+
+        const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator(end());
+        }
+
+        const_reverse_iterator crbegin() const noexcept
+        {
+            return const_reverse_iterator(cend());
+        }
+
+        reverse_iterator rend() noexcept
+        {
+            return reverse_iterator(begin());
+        }
+
+        const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator(begin());
+        }
+
+        const_reverse_iterator crend() const noexcept
+        {
+            return const_reverse_iterator(cbegin());
+        }
+
+        bool empty() const noexcept
+        {
+            return count == 0;
+        }
+
+        size_type size() const noexcept
+        {
+            return count;
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        void push_front(const T& value) noexcept
+        {
+            emplace_front(value);
+        }
+
+        void push_front(T&& value) noexcept
+        {
+            emplace_front(std::move(value));
+        }
+
+        void push_back(const T& value) noexcept
+        {
+            emplace_back(value);
+        }
+
+        void push_back(T&& value) noexcept
+        {
+            emplace_back(std::move(value));
+        }
+
+        template <typename... Args>
+        void emplace_front(Args&&... args)
+        {
+            auto next = next_sequence();
+            if (count == capacity())
+            {
+                // the slot before head is the back, overwrite it in place
+                head = wrap(head + MS - 1);
+                slot(head) = T(std::forward<Args>(args)...);
+            }
+            else
+            {
+                auto i = wrap(head + MS - 1);
+                new (address(i)) T(std::forward<Args>(args)...);
+                head = i;
+                count++;
+            }
+            end_numbering(next);
+        }
+
+        template <typename... Args>
+        void emplace_back(Args&&... args)
+        {
+            if (count == capacity())
+            {
+                // the tail is the head, overwrite the oldest element in place
+                slot(head) = T(std::forward<Args>(args)...);
+                head = wrap(head + 1);
+                first_seq++;
+            }
+            else
+            {
+                new (address(wrap(head + count))) T(std::forward<Args>(args)...);
+                count++;
+            }
+        }
+
+        void pop_front() noexcept
+        {
+            slot(head).~T();
+            head = wrap(head + 1);
+            count--;
+            first_seq++;
+        }
+
+        void pop_back() noexcept
+        {
+            auto next = next_sequence();
+            element(count - 1).~T();
+            count--;
+            end_numbering(next);
+        }
+
+        iterator insert(const_iterator pos, const T& value)
+        {
+            return emplace(pos, value);
+        }
+
+        iterator insert(const_iterator pos, T&& value)
+        {
+            return emplace(pos, std::move(value));
+        }
+
+        template< class InputIt >
+        iterator insert(const_iterator pos, InputIt first, InputIt last )
+        {
+            auto start = static_cast<size_type>(pos.index);
+            if (first == last || start == capacity())
+            {
+                // nothing is stored, so the numbering goes on
+                return begin() + start;
+            }
+
+            auto next  = next_sequence();
+            auto i     = start;
+            for (; first != last && i < capacity(); ++first, ++i)
+            {
+                emplace(cbegin() + i, *first);
+            }
+            end_numbering(next);
+            return begin() + start;
+        }
+
+        template <typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args)
+        {
+            auto i = static_cast<size_type>(pos.index);
+            if (i == capacity())
+            {
+                // inserting past the last slot is culled right away
+                return end();
+            }
+
+            auto next = next_sequence();
+            auto value = T(std::forward<Args>(args)...);
+            if (count == capacity())
+            {
+                pop_back();
+            }
+
+            if (i == count)
+            {
+                emplace_back(std::move(value));
+            }
+            else
+            {
+                emplace_back(std::move(back()));
+                std::move_backward(begin() + i, end() - 2, end() - 1);
+                element(i) = std::move(value);
+            }
+            end_numbering(next);
+            return begin() + i;
+        }
+
+        //! Push a range of elements to the back.
+        //!
+        //! The result is the same as calling push_back for each element, but
+        //! only the last MS elements of the range are copied.
+        template <typename InputIt>
+        void append(InputIt first, InputIt last)
+        {
+            auto start = last_n(first, last);
+            // the skipped elements count as pushed and evicted right away
+            first_seq += static_cast<std::uint64_t>(std::distance(first, start));
+            for (first = start; first != last; ++first)
+            {
+                emplace_back(*first);
+            }
+        }
+
+        //! Push a range of elements to the back.
+        void append(const array_view<T>& values)
+        {
+            append(values.begin(), values.end());
+        }
+
+        //! Push a range of elements to the front.
+        //!
+        //! The result is the same as calling push_front for each element, so
+        //! the last element of the range ends up at the front. Only the last
+        //! MS elements of the range are copied.
+        template <typename InputIt>
+        void prepend(InputIt first, InputIt last)
+        {
+            if (first == last)
+            {
+                // nothing is stored, so the numbering goes on
+                return;
+            }
+            auto next = next_sequence();
+            for (first = last_n(first, last); first != last; ++first)
+            {
+                emplace_front(*first);
+            }
+            end_numbering(next);
+        }
+
+        //! Push a range of elements to the front.
+        void prepend(const array_view<T>& values)
+        {
+            prepend(values.begin(), values.end());
+        }
+
+        //! Move up to n elements from the front to out.
+        //!
+        //! @return the output iterator past the last element written
+        template <typename OutputIt>
+        OutputIt pop_front_n(size_type n, OutputIt out)
+        {
+            n = std::min(n, count);
+            for (auto& seg : front_runs(n))
+            {
+                out = std::move(seg.first, seg.first + seg.second, out);
+            }
+            release_front(n);
+            return out;
+        }
+
+        //! Move all elements to the back of c and clear the ring.
+        //!
+        //! @return the number of elements moved
+        template <typename C>
+        size_type drain_into(C& c)
+        {
+            auto n = count;
+            c.insert(std::end(c), std::make_move_iterator(begin()), std::make_move_iterator(end()));
+            clear();
+            return n;
+        }
+
+        //! Pass up to n elements from the front to fn and release them.
+        //!
+        //! fn is called with array_view<T> over at most two contiguous
+        //! segments of the storage, so nothing is copied.
+        //!
+        //! @return the number of elements consumed
+        template <typename Fn>
+        size_type consume(size_type n, Fn&& fn)
+        {
+            n = std::min(n, count);
+            for (auto& seg : front_runs(n))
+            {
+                if (seg.second != 0)
+                {
+                    fn(array_view<T>(seg.first, seg.second));
+                }
+            }
+            release_front(n);
+            return n;
+        }
+
+        void clear() noexcept
+        {
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                for (auto i = 0u; i < count; i++)
+                {
+                    element(i).~T();
+                }
+            }
+            first_seq += count;
+            head       = 0;
+            count      = 0;
+            numbered   = true;
+        }
+
+        void swap(ring<T, MS, inline_storage>& other) noexcept
+        {
+            auto tmp = std::move(other);
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        //! Sequence number of the front element.
+        //!
+        //! Every element pushed to the back gets the next sequence number,
+        //! so a reader can remember where it left off. When the reader's
+        //! position is smaller than oldest_sequence, the elements in between
+        //! were evicted.
+        //!
+        //! Numbers are never reused and next_sequence never decreases.
+        //! Pushing to the front, inserting in the middle, prepend and
+        //! pop_back would shift or reuse the numbers of the held elements,
+        //! so they end the numbering instead: sequenced turns false,
+        //! at_sequence finds nothing and oldest_sequence equals
+        //! next_sequence. After clear the elements pushed to the back are
+        //! numbered again, following every number handed out so far.
+        std::uint64_t oldest_sequence() const noexcept
+        {
+            return numbered ? first_seq : next_sequence();
+        }
+
+        //! Sequence number the next element pushed to the back will get.
+        std::uint64_t next_sequence() const noexcept
+        {
+            return first_seq + count;
+        }
+
+        //! Whether the elements can be looked up by sequence number.
+        //!
+        //! See oldest_sequence for the mutations that end the numbering.
+        bool sequenced() const noexcept
+        {
+            return numbered;
+        }
+
+        //! The element with sequence number n.
+        //!
+        //! @return nullptr if the element was evicted, is not pushed yet or
+        //! the ring is not sequenced
+        pointer at_sequence(std::uint64_t n) noexcept
+        {
+            auto i = n - first_seq;
+            return numbered && i < count ? &element(static_cast<size_type>(i)) : nullptr;
+        }
+
+        //! The element with sequence number n.
+        //!
+        //! @return nullptr if the element was evicted, is not pushed yet or
+        //! the ring is not sequenced
+        const_pointer at_sequence(std::uint64_t n) const noexcept
+        {
+            auto i = n - first_seq;
+            return numbered && i < count ? &element(static_cast<size_type>(i)) : nullptr;
+        }
+
+    private:
+        struct storage_slot
+        {
+            alignas(T) unsigned char raw[sizeof(T)];
+        };
+
+        storage_slot  slots[MS];
+        size_type     head      = 0;
+        size_type     count     = 0;
+        std::uint64_t first_seq = 0;
+        bool          numbered  = true;
+
+        //! Stop numbering the elements, next_sequence stays at next.
+        void end_numbering(std::uint64_t next) noexcept
+        {
+            first_seq = next - count;
+            numbered  = false;
+        }
+
+        //! Map a position in [0, 2 * MS) onto a slot index.
+        static constexpr size_type wrap(size_type i) noexcept
+        {
+            if constexpr ((MS & (MS - 1)) == 0)
+            {
+                return i & (MS - 1);
+            }
+            else
+            {
+                return i < MS ? i : i - MS;
+            }
+        }
+
+        //! Skip all but the last MS elements of a forward range.
+        template <typename InputIt>
+        static InputIt last_n(InputIt first, InputIt last)
+        {
+            using category = typename std::iterator_traits<InputIt>::iterator_category;
+            if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>)
+            {
+                auto n = static_cast<size_type>(std::distance(first, last));
+                if (n > MS)
+                {
+                    std::advance(first, n - MS);
+                }
+            }
+            return first;
+        }
+
+        void* address(size_type i) noexcept
+        {
+            return slots[i].raw;
+        }
+
+        T* slot_pointer(size_type i) noexcept
+        {
+            return reinterpret_cast<T*>(slots[i].raw);
+        }
+
+        const T* slot_pointer(size_type i) const noexcept
+        {
+            return reinterpret_cast<const T*>(slots[i].raw);
+        }
+
+        T& slot(size_type i) noexcept
+        {
+            return *std::launder(reinterpret_cast<T*>(slots[i].raw));
+        }
+
+        const T& slot(size_type i) const noexcept
+        {
+            return *std::launder(reinterpret_cast<const T*>(slots[i].raw));
+        }
+
+        T& element(size_type i) noexcept
+        {
+            return slot(wrap(head + i));
+        }
+
+        const T& element(size_type i) const noexcept
+        {
+            return slot(wrap(head + i));
+        }
+
+        //! The first n elements as up to two runs of storage.
+        std::array<std::pair<T*, size_type>, 2> front_runs(size_type n) noexcept
+        {
+            auto first = std::min(n, MS - head);
+            return {std::make_pair(slot_pointer(head), first), std::make_pair(slot_pointer(0), n - first)};
+        }
+
+        //! Destroy the first n elements and advance the head past them.
+        void release_front(size_type n) noexcept
+        {
+            if constexpr (!std::is_trivially_destructible_v<T>)
+            {
+                for (auto i = 0u; i < n; i++)
+                {
+                    element(i).~T();
+                }
+            }
+            head       = wrap(head + n);
+            count     -= n;
+            first_seq += n;
+        }
+
+        template <bool Const>
+        class basic_iterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type        = T;
+            using difference_type   = std::ptrdiff_t;
+            using pointer           = std::conditional_t<Const, const T*, T*>;
+            using reference         = std::conditional_t<Const, const T&, T&>;
+            using owner_type        = std::conditional_t<Const, const ring<T, MS, inline_storage>, ring<T, MS, inline_storage>>;
+
+            basic_iterator() noexcept = default;
+
+            basic_iterator(owner_type* o, difference_type i) noexcept
+            : owner(o), index(i) {}
+
+            template <bool C = Const, typename = std::enable_if_t<C>>
+            basic_iterator(const basic_iterator<false>& other) noexcept
+            : owner(other.owner), index(other.index) {}
+
+            reference operator * () const noexcept
+            {
+                return owner->element(static_cast<size_type>(index));
+            }
+
+            pointer operator -> () const noexcept
+            {
+                return &owner->element(static_cast<size_type>(index));
+            }
+
+            reference operator [] (difference_type n) const noexcept
+            {
+                return owner->element(static_cast<size_type>(index + n));
+            }
+
+            basic_iterator& operator ++ () noexcept
+            {
+                index++;
+                return *this;
+            }
+
+            basic_iterator& operator -- () noexcept
+            {
+                index--;
+                return *this;
+            }
+
+            basic_iterator operator ++ (int) noexcept
+            {
+                auto old = *this;
+                index++;
+                return old;
+            }
+
+            basic_iterator operator -- (int) noexcept
+            {
+                auto old = *this;
+                index--;
+                return old;
+            }
+
+            basic_iterator& operator += (difference_type n) noexcept
+            {
+                index += n;
+                return *this;
+            }
+
+            basic_iterator& operator -= (difference_type n) noexcept
+            {
+                index -= n;
+                return *this;
+            }
+
+            friend basic_iterator operator + (basic_iterator i, difference_type n) noexcept
+            {
+                return i += n;
+            }
+
+            friend basic_iterator operator + (difference_type n, basic_iterator i) noexcept
+            {
+                return i += n;
+            }
+
+            friend basic_iterator operator - (basic_iterator i, difference_type n) noexcept
+            {
+                return i -= n;
+            }
+
+            friend difference_type operator - (const basic_iterator& a, const basic_iterator& b) noexcept
+            {
+                return a.index - b.index;
+            }
+
+            friend bool operator == (const basic_iterator& a, const basic_iterator& b) noexcept
+            {
+                return a.index == b.index;
+            }
+
+            friend bool operator != (const basic_iterator& a, const basic_iterator& b) noexcept
+            {
+                return a.index != b.index;
+            }
+
+            friend bool operator < (const basic_iterator& a, const basic_iterator& b) noexcept
+            {
+                return a.index < b.index;
+            }
+
+            friend bool operator > (const basic_iterator& a, const basic_iterator& b) noexcept
+            {
+                return a.index > b.index;
+            }
+
+            friend bool operator <= (const basic_iterator& a, const basic_iterator& b) noexcept
+            {
+                return a.index <= b.index;
+            }
+
+            friend bool operator >= (const basic_iterator& a, const basic_iterator& b) noexcept
+            {
+                return a.index >= b.index;
+            }
+
+        private:
+            owner_type*     owner = nullptr;
+            difference_type index = 0;
+
+            friend class ring<T, MS, inline_storage>;
+            friend class basic_iterator<!Const>;
+        };
+    };
+}
+
+namespace stdex::pmr
+{
+    //! A ring whose deque allocates from a std::pmr::memory_resource.
+    template <typename T, std::size_t MS>
+    using ring = stdex::ring<T, MS, std::pmr::deque<T>>;
+}
+
+namespace std
+{
+    //! A ring uses an allocator when its container does, so allocator
+    //! aware containers, such as a std::pmr::vector of rings, pass their
+    //! allocator on to the rings.
+    template <typename T, std::size_t MS, typename Container, std::size_t Slack, typename Alloc>
+    struct uses_allocator<stdex::ring<T, MS, Container, Slack>, Alloc> : uses_allocator<Container, Alloc> {};
 }
@@ -0,0 +1,243 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "ring.h"
+
+namespace stdex
+{
+    //! Aggregate buckets by adding up their values.
+    struct rollup_sum
+    {
+        template <typename T>
+        T operator () (const T& acc, const T& value) const
+        {
+            return acc + value;
+        }
+    };
+
+    //! Aggregate buckets by keeping the smallest value.
+    struct rollup_min
+    {
+        template <typename T>
+        T operator () (const T& acc, const T& value) const
+        {
+            return std::min(acc, value);
+        }
+    };
+
+    //! Aggregate buckets by keeping the largest value.
+    struct rollup_max
+    {
+        template <typename T>
+        T operator () (const T& acc, const T& value) const
+        {
+            return std::max(acc, value);
+        }
+    };
+
+    //! Aggregate buckets by keeping the newest value.
+    struct rollup_last
+    {
+        template <typename T>
+        T operator () (const T&, const T& value) const
+        {
+            return value;
+        }
+    };
+
+    //! Rollup Ring
+    //!
+    //! A multi resolution history, such as one second buckets for an hour,
+    //! one minute buckets for a day and one hour buckets for a month.
+    //!
+    //! Every tier is a ring of MS buckets with a fixed resolution, the
+    //! resolutions growing from tier to tier. Samples are folded with Op into
+    //! the bucket of the finest tier that covers their time. When a tier is
+    //! full, its oldest bucket is folded into the next coarser tier and
+    //! buckets evicted from the coarsest tier are dropped. Every sample is
+    //! thus held by exactly one bucket, the coarse tiers holding the older
+    //! data.
+    //!
+    //! Samples must be pushed in chronological order; a sample stamped
+    //! earlier than the newest bucket is folded into the newest bucket.
+    template <typename T, typename Op, typename Clock, std::size_t... MS>
+    class basic_rollup_ring
+    {
+        static_assert(sizeof...(MS) > 0, "rollup_ring needs at least one tier");
+
+    public:
+        using value_type = T;
+        using clock      = Clock;
+        using duration   = typename Clock::duration;
+        using time_point = typename Clock::time_point;
+        using size_type  = std::size_t;
+
+        //! The aggregate of the samples within [time, time + resolution).
+        struct bucket
+        {
+            time_point time;
+            T          value;
+        };
+
+        //! A bucket returned by a range query.
+        struct datapoint
+        {
+            time_point time;
+            duration   resolution;
+            T          value;
+        };
+
+        static constexpr size_type tier_count = sizeof...(MS);
+
+        //! Create a rollup ring.
+        //!
+        //! @param tier_resolutions bucket width of each tier, finest first
+        //! @param fold how samples and buckets are folded into a bucket
+        explicit basic_rollup_ring(const std::array<duration, tier_count>& tier_resolutions, Op fold = Op())
+        : resolutions(tier_resolutions), op(std::move(fold))
+        {
+            for (auto i = 0u; i < tier_count; i++)
+            {
+                if (resolutions[i] <= duration::zero() || (i > 0 && resolutions[i] <= resolutions[i - 1]))
+                {
+                    throw std::invalid_argument("rollup_ring: resolutions must be positive and increasing");
+                }
+            }
+        }
+
+        duration resolution(size_type i) const noexcept
+        {
+            return resolutions[i];
+        }
+
+        //! The buckets of tier I, oldest first.
+        template <std::size_t I>
+        const auto& tier() const noexcept
+        {
+            return std::get<I>(tiers);
+        }
+
+        //! Total number of buckets in all tiers.
+        size_type size() const noexcept
+        {
+            return std::apply([] (const auto&... t) { return (t.size() + ...); }, tiers);
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        //! Fold a sample into the bucket of the finest tier covering now.
+        void push_back(const T& value, time_point now = Clock::now())
+        {
+            fold_into<0>(bucket{now, value});
+        }
+
+        //! The buckets overlapping [from, to), oldest first.
+        //!
+        //! Each part of the interval is answered by the finest tier that
+        //! still holds it, so the result starts with coarse buckets and
+        //! gets finer towards the present. Since every sample is held by a
+        //! single bucket, a coarse bucket and the fine buckets following
+        //! it may share a time span but never a sample.
+        //!
+        //! @return the output iterator past the last datapoint written
+        template <typename OutputIt>
+        OutputIt query(time_point from, time_point to, OutputIt out) const
+        {
+            return query_tier<tier_count - 1>(from, to, out);
+        }
+
+        void clear() noexcept
+        {
+            std::apply([] (auto&... t) { (t.clear(), ...); }, tiers);
+        }
+
+    private:
+        std::array<duration, tier_count>  resolutions;
+        Op                                op;
+        std::tuple<ring<bucket, MS>...>   tiers;
+
+        time_point bucket_start(time_point t, size_type i) const noexcept
+        {
+            auto since = t.time_since_epoch();
+            auto n     = since / resolutions[i];
+            if (since % resolutions[i] < duration::zero())
+            {
+                n--;
+            }
+            return time_point(n * resolutions[i]);
+        }
+
+        template <std::size_t I>
+        void fold_into(const bucket& b)
+        {
+            if constexpr (I < tier_count)
+            {
+                auto& tier  = std::get<I>(tiers);
+                auto  start = bucket_start(b.time, I);
+                if (!tier.empty() && start <= tier.back().time)
+                {
+                    tier.back().value = op(tier.back().value, b.value);
+                    return;
+                }
+
+                if (tier.size() == tier.capacity())
+                {
+                    auto evicted = std::move(tier.front());
+                    tier.pop_front();
+                    fold_into<I + 1>(evicted);
+                }
+                tier.push_back(bucket{start, b.value});
+            }
+        }
+
+        template <std::size_t I, typename OutputIt>
+        OutputIt query_tier(time_point from, time_point to, OutputIt out) const
+        {
+            const auto& tier = std::get<I>(tiers);
+            auto        res  = resolutions[I];
+            for (const auto& b : tier)
+            {
+                if (b.time >= to)
+                {
+                    break;
+                }
+                if (b.time + res > from)
+                {
+                    *out++ = datapoint{b.time, res, b.value};
+                }
+            }
+
+            if constexpr (I > 0)
+            {
+                return query_tier<I - 1>(from, to, out);
+            }
+            else
+            {
+                return out;
+            }
+        }
+    };
+
+    //! Rollup ring on the steady clock.
+    template <typename T, typename Op, std::size_t... MS>
+    using rollup_ring = basic_rollup_ring<T, Op, std::chrono::steady_clock, MS...>;
+}
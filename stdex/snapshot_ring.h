@@ -0,0 +1,217 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+#include "array_view.h"
+#include "concurrency.h"
+
+namespace stdex
+{
+    //! Snapshot Ring
+    //!
+    //! A single writer ring with MS slots that any number of readers can
+    //! take consistent snapshots of, such as a metrics ring filled by a hot
+    //! thread and scraped by a monitoring endpoint.
+    //!
+    //! The writer never waits; push_back is wait free and overwrites the
+    //! oldest slot. It announces the position it is about to write before
+    //! touching the slot and publishes it afterwards, like a sequence lock
+    //! spanning the whole ring. A reader copies the published elements and
+    //! then checks which of the slots it copied the writer got to meanwhile.
+    //! This requires T to be trivially copyable. T must also be default
+    //! constructible for snapshot to return a std::vector<T>.
+    //!
+    //! The slots are atomic_words, so snapshot copies the elements out
+    //! without a data race. Only try_visit and visit read the slots in
+    //! place as plain T; see there.
+    template <typename T, std::size_t MS>
+    class snapshot_ring
+    {
+        static_assert(MS > 0, "ring capacity must not be zero");
+        static_assert(std::is_trivially_copyable_v<T>, "snapshot_ring requires a trivially copyable type");
+        static_assert(std::is_default_constructible_v<T>, "snapshot_ring requires a default constructible type");
+        static_assert(sizeof(atomic_words<T>) == sizeof(T), "snapshot_ring requires atomic_words<T> to have the layout of T");
+
+    public:
+        using value_type = T;
+        using size_type  = std::size_t;
+
+        snapshot_ring() noexcept = default;
+        snapshot_ring(const snapshot_ring<T, MS>&) = delete;
+        snapshot_ring(snapshot_ring<T, MS>&&) = delete;
+        ~snapshot_ring() = default;
+        snapshot_ring<T, MS>& operator = (const snapshot_ring<T, MS>&) = delete;
+        snapshot_ring<T, MS>& operator = (snapshot_ring<T, MS>&&) = delete;
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Number of published elements.
+        size_type size() const noexcept
+        {
+            auto w = next_sequence();
+            return static_cast<size_type>(w < MS ? w : MS);
+        }
+
+        bool empty() const noexcept
+        {
+            return next_sequence() == 0;
+        }
+
+        //! Sequence number of the next element written.
+        std::uint64_t next_sequence() const noexcept
+        {
+            return write_pos.load(std::memory_order_acquire);
+        }
+
+        //! Add an element, overwriting the oldest when full. (writer)
+        void push_back(const T& value) noexcept
+        {
+            auto pos = write_pos.load(std::memory_order_relaxed);
+            claim.store(pos + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slots[pos % MS].store(value);
+            write_pos.store(pos + 1, std::memory_order_release);
+        }
+
+        //! Copy the newest elements to out, oldest first.
+        //!
+        //! The elements copied are consecutive and were all held by the
+        //! ring at the same time. Elements the writer overwrote while they
+        //! were copied are dropped from the front, so with a busy writer
+        //! fewer than out.size() elements may be returned even though the
+        //! ring holds more. The copy is only retried if the writer lapped
+        //! all of it.
+        //!
+        //! @return the number of elements written to out
+        size_type snapshot(array_span<T> out) const noexcept
+        {
+            auto b = backoff();
+            while (true)
+            {
+                auto w     = next_sequence();
+                auto n     = std::min<std::uint64_t>({w, MS, out.size()});
+                if (n == 0)
+                {
+                    return 0;
+                }
+                auto start = w - n;
+                copy(start, w, out.data());
+
+                auto first = valid_from(start);
+                if (first < w)
+                {
+                    auto drop = static_cast<size_type>(first - start);
+                    std::memmove(out.data(), out.data() + drop, (n - drop) * sizeof(T));
+                    return static_cast<size_type>(n - drop);
+                }
+                b.pause();
+            }
+        }
+
+        //! Copy the newest elements, oldest first.
+        //!
+        //! Only as many elements as are published when it is called are
+        //! copied; the ones pushed meanwhile are left for the next snapshot.
+        //!
+        //! @see snapshot(array_span<T>)
+        std::vector<T> snapshot() const
+        {
+            auto values = std::vector<T>(size());
+            values.resize(snapshot(array_span<T>(values.data(), values.size())));
+            return values;
+        }
+
+        //! Visit the elements in place as two segments, oldest first.
+        //!
+        //! Since the writer may overwrite the slots while fn reads them, fn
+        //! may see torn elements and must discard what it computed when
+        //! try_visit fails. Unlike snapshot, fn reads the slots as plain T
+        //! and not through their atomic words, so these reads race with
+        //! the writer and are not well defined by the standard; they only
+        //! behave on platforms where a torn read is harmless. fn runs in a
+        //! seqlock_read_scope, so ThreadSanitizer does not report them. Use
+        //! snapshot where that is not acceptable.
+        //!
+        //! @return false if the writer overwrote any visited element
+        template <typename Fn>
+        bool try_visit(Fn&& fn) const
+        {
+            auto w     = next_sequence();
+            auto n     = std::min<std::uint64_t>(w, MS);
+            auto start = w - n;
+            auto head  = static_cast<size_type>(start % MS);
+            auto first = std::min(static_cast<size_type>(n), MS - head);
+            {
+                auto scope = seqlock_read_scope();
+                auto values = reinterpret_cast<const T*>(slots);
+                fn(array_view<T>(values + head, first), array_view<T>(values, static_cast<size_type>(n) - first));
+            }
+            return valid_from(start) == start;
+        }
+
+        //! Visit the elements in place, retrying until fn saw a consistent state.
+        //!
+        //! With a writer that pushes faster than fn visits the ring, this
+        //! does not make progress; use snapshot in that case.
+        template <typename Fn>
+        void visit(Fn&& fn) const
+        {
+            auto b = backoff();
+            while (!try_visit(fn))
+            {
+                b.pause();
+            }
+        }
+
+    private:
+        alignas(cache_line_size) std::atomic<std::uint64_t> write_pos = {0};
+        // one past the position the writer writes or last wrote
+        std::atomic<std::uint64_t>                          claim     = {0};
+        alignas(cache_line_size) atomic_words<T>            slots[MS];
+
+        //! Copy the positions [first, last) to out.
+        void copy(std::uint64_t first, std::uint64_t last, T* out) const noexcept
+        {
+            auto n    = static_cast<size_type>(last - first);
+            auto head = static_cast<size_type>(first % MS);
+            auto part = std::min(n, MS - head);
+            for (auto i = size_type(0); i < part; i++)
+            {
+                slots[head + i].load(out[i]);
+            }
+            for (auto i = part; i < n; i++)
+            {
+                slots[i - part].load(out[i]);
+            }
+        }
+
+        //! The first position at or after start that is not overwritten.
+        //!
+        //! Called after reading the slots; writing position p overwrites
+        //! position p - MS.
+        std::uint64_t valid_from(std::uint64_t start) const noexcept
+        {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto c = claim.load(std::memory_order_relaxed);
+            return c > MS + start ? c - MS : start;
+        }
+    };
+}
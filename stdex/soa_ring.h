@@ -0,0 +1,198 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#include "array_view.h"
+
+namespace stdex
+{
+    //! Structure of Arrays Ring
+    //!
+    //! A ring of MS rows with N channels each, such as one sample of every
+    //! sensor per tick, that stores every channel as its own contiguous
+    //! column. All columns share the same head and size, so a row is
+    //! pushed and evicted as a whole.
+    //!
+    //! Unlike a ring of std::array<T, N>, scanning one channel only touches
+    //! that channel's memory. Each column is exposed as two contiguous
+    //! segments, like ring<T, MS, inline_storage>::segments, that can be
+    //! handed to filters and transforms as they are.
+    template <typename T, std::size_t N, std::size_t MS>
+    class soa_ring
+    {
+        static_assert(N > 0, "soa_ring needs at least one channel");
+        static_assert(MS > 0, "ring capacity must not be zero");
+
+    public:
+        using value_type = T;
+        using size_type  = std::size_t;
+        using row_type   = std::array<T, N>;
+
+        soa_ring() noexcept = default;
+
+        bool empty() const noexcept
+        {
+            return count == 0;
+        }
+
+        //! Number of rows.
+        size_type size() const noexcept
+        {
+            return count;
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Number of channels.
+        static constexpr size_type channels() noexcept
+        {
+            return N;
+        }
+
+        //! Add a row to the back, evicting the front row when full.
+        void push_back(const row_type& row) noexcept
+        {
+            auto i = next_slot();
+            for (auto c = 0u; c < N; c++)
+            {
+                columns[c][i] = row[c];
+            }
+        }
+
+        void pop_front() noexcept
+        {
+            assert(count > 0);
+            head = wrap(head + 1);
+            count--;
+        }
+
+        //! Remove the n front rows.
+        void pop_front(size_type n) noexcept
+        {
+            assert(n <= count);
+            head   = wrap(head + n);
+            count -= n;
+        }
+
+        void clear() noexcept
+        {
+            head  = 0;
+            count = 0;
+        }
+
+        //! The value of channel c in row i, counted from the front.
+        const T& value(size_type c, size_type i) const noexcept
+        {
+            assert(c < N && i < count);
+            return columns[c][wrap(head + i)];
+        }
+
+        T& value(size_type c, size_type i) noexcept
+        {
+            assert(c < N && i < count);
+            return columns[c][wrap(head + i)];
+        }
+
+        //! The value of channel c in row i, counted from the front.
+        //!
+        //! @throw std::out_of_range if c or i is out of range
+        const T& at(size_type c, size_type i) const
+        {
+            if (c >= N || i >= count)
+            {
+                throw std::out_of_range("soa_ring: index out of range");
+            }
+            return value(c, i);
+        }
+
+        //! Gather row i, counted from the front.
+        row_type row(size_type i) const noexcept
+        {
+            auto r = row_type();
+            for (auto c = 0u; c < N; c++)
+            {
+                r[c] = value(c, i);
+            }
+            return r;
+        }
+
+        row_type front() const noexcept
+        {
+            return row(0);
+        }
+
+        row_type back() const noexcept
+        {
+            return row(count - 1);
+        }
+
+        //! The values of channel c as contiguous segments in logical order.
+        //!
+        //! The second segment is only non empty when the rows wrap around
+        //! the end of the storage.
+        std::array<array_view<T>, 2> segments(size_type c) const noexcept
+        {
+            assert(c < N);
+            auto first = std::min(count, MS - head);
+            return {array_view<T>(columns[c].data() + head, first), array_view<T>(columns[c].data(), count - first)};
+        }
+
+        //! The free slots of channel c after the back as contiguous segments.
+        //!
+        //! The slots of every channel can be filled in place and are added
+        //! to the ring as rows with commit.
+        std::array<array_span<T>, 2> free_segments(size_type c) noexcept
+        {
+            assert(c < N);
+            auto tail  = wrap(head + count);
+            auto free  = MS - count;
+            auto first = std::min(free, MS - tail);
+            return {array_span<T>(columns[c].data() + tail, first), array_span<T>(columns[c].data(), free - first)};
+        }
+
+        //! Add n rows written through free_segments to the back.
+        void commit(size_type n) noexcept
+        {
+            assert(count + n <= MS);
+            count += n;
+        }
+
+    private:
+        std::array<std::array<T, MS>, N> columns = {};
+        size_type                        head    = 0;
+        size_type                        count   = 0;
+
+        static constexpr size_type wrap(size_type i) noexcept
+        {
+            return i % MS;
+        }
+
+        //! The slot of the new back row, evicting the front row when full.
+        size_type next_slot() noexcept
+        {
+            if (count == MS)
+            {
+                auto i = head;
+                head = wrap(head + 1);
+                return i;
+            }
+            return wrap(head + count++);
+        }
+    };
+}
@@ -0,0 +1,288 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#include "concurrency.h"
+
+namespace stdex
+{
+    //! What a bounded queue does when pushing onto a full queue.
+    enum class overflow_policy
+    {
+        //! The push fails and the queue is left unchanged.
+        reject,
+        //! The oldest element is dropped, like ring::push_back.
+        overwrite
+    };
+
+    //! Single Producer Single Consumer Ring
+    //!
+    //! A lock free queue with a fixed capacity of MS elements. Exactly one
+    //! thread may push and exactly one thread may pop at any given time.
+    //!
+    //! With overflow_policy::overwrite the producer drops the oldest element
+    //! when the queue is full. Since the producer then competes with the
+    //! consumer for the oldest slot, the consumer copies the element and only
+    //! keeps it when it won the race; this requires T to be trivially
+    //! copyable. The slots are then stored as atomic_words, so the copy of
+    //! a slot that is being overwritten is not a data race.
+    template <typename T, std::size_t MS, overflow_policy Policy = overflow_policy::reject>
+    class spsc_ring
+    {
+        static_assert(MS > 0, "ring capacity must not be zero");
+        static_assert(Policy != overflow_policy::overwrite || std::is_trivially_copyable_v<T>,
+                      "overwriting spsc_ring requires a trivially copyable type");
+
+    public:
+        using value_type      = T;
+        using size_type       = std::size_t;
+        using reference       = value_type&;
+        using const_reference = const value_type&;
+
+        spsc_ring() noexcept = default;
+        spsc_ring(const spsc_ring<T, MS, Policy>&) = delete;
+        spsc_ring(spsc_ring<T, MS, Policy>&&) = delete;
+
+        ~spsc_ring()
+        {
+            if constexpr (Policy == overflow_policy::reject && !std::is_trivially_destructible_v<T>)
+            {
+                auto t = tail.load(std::memory_order_relaxed);
+                for (auto h = head.load(std::memory_order_relaxed); h != t; h++)
+                {
+                    slot(h).~T();
+                }
+            }
+        }
+
+        spsc_ring<T, MS, Policy>& operator = (const spsc_ring<T, MS, Policy>&) = delete;
+        spsc_ring<T, MS, Policy>& operator = (spsc_ring<T, MS, Policy>&&) = delete;
+
+        //! Number of elements in the queue.
+        //!
+        //! The value is only a snapshot when called while the other side
+        //! is active.
+        size_type size() const noexcept
+        {
+            auto h = head.load(std::memory_order_acquire);
+            auto t = tail.load(std::memory_order_acquire);
+            return t - h;
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        constexpr size_type capacity() const noexcept
+        {
+            return MS;
+        }
+
+        //! Push an element. (producer)
+        //!
+        //! @return false if the queue is full and the policy is reject
+        bool try_push(const T& value)
+        {
+            return try_emplace(value);
+        }
+
+        //! Push an element. (producer)
+        //!
+        //! @return false if the queue is full and the policy is reject
+        bool try_push(T&& value)
+        {
+            return try_emplace(std::move(value));
+        }
+
+        //! Construct an element in place. (producer)
+        //!
+        //! @return false if the queue is full and the policy is reject
+        template <typename... Args>
+        bool try_emplace(Args&&... args)
+        {
+            auto t = tail.load(std::memory_order_relaxed);
+            if (!make_room(t))
+            {
+                return false;
+            }
+            if constexpr (Policy == overflow_policy::reject)
+            {
+                new (address(t)) T(std::forward<Args>(args)...);
+            }
+            else
+            {
+                slots[t % MS].store(T(std::forward<Args>(args)...));
+            }
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! Push a range of elements. (producer)
+        //!
+        //! With the reject policy the elements are published together with
+        //! a single store.
+        //!
+        //! @return the number of elements pushed
+        template <typename InputIt>
+        size_type try_push(InputIt first, InputIt last)
+        {
+            auto n = size_type(0);
+            if constexpr (Policy == overflow_policy::reject)
+            {
+                auto t = tail.load(std::memory_order_relaxed);
+                for (; first != last && make_room(t + n); ++first, ++n)
+                {
+                    new (address(t + n)) T(*first);
+                }
+                if (n != 0)
+                {
+                    tail.store(t + n, std::memory_order_release);
+                }
+            }
+            else
+            {
+                // dropped elements must be published, so push one by one
+                for (; first != last; ++first, ++n)
+                {
+                    try_emplace(*first);
+                }
+            }
+            return n;
+        }
+
+        //! Pop the oldest element. (consumer)
+        //!
+        //! @return false if the queue is empty
+        bool try_pop(T& value)
+        {
+            return try_pop(&value, 1) == 1;
+        }
+
+        //! Pop up to n elements. (consumer)
+        //!
+        //! With the reject policy the slots are released together with a
+        //! single store.
+        //!
+        //! @return the number of elements written to out
+        template <typename OutputIt>
+        size_type try_pop(OutputIt out, size_type n)
+        {
+            if constexpr (Policy == overflow_policy::reject)
+            {
+                auto h = head.load(std::memory_order_relaxed);
+                auto avail = cached_tail - h;
+                if (avail < n)
+                {
+                    cached_tail = tail.load(std::memory_order_acquire);
+                    avail = cached_tail - h;
+                }
+                auto count = avail < n ? avail : n;
+                for (auto i = size_type(0); i < count; i++)
+                {
+                    auto& v = slot(h + i);
+                    *out = std::move(v);
+                    ++out;
+                    v.~T();
+                }
+                if (count != 0)
+                {
+                    head.store(h + count, std::memory_order_release);
+                }
+                return count;
+            }
+            else
+            {
+                // the producer advances head to drop elements, so copy the
+                // element and keep it only if head did not move meanwhile
+                auto count = size_type(0);
+                auto h = head.load(std::memory_order_acquire);
+                while (count < n)
+                {
+                    if (h == tail.load(std::memory_order_acquire))
+                    {
+                        break;
+                    }
+                    storage_slot copy;
+                    slots[h % MS].load(*reinterpret_cast<T*>(copy.raw));
+                    if (head.compare_exchange_weak(h, h + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                    {
+                        *out = *std::launder(reinterpret_cast<T*>(copy.raw));
+                        ++out;
+                        ++count;
+                        ++h;
+                    }
+                }
+                return count;
+            }
+        }
+
+    private:
+        struct storage_slot
+        {
+            alignas(T) unsigned char raw[sizeof(T)];
+        };
+
+        using slot_type = std::conditional_t<Policy == overflow_policy::reject, storage_slot, atomic_words<T>>;
+
+        // head and tail are free running counters, the slot is counter % MS
+        alignas(cache_line_size) std::atomic<size_type> head = {0};
+        size_type                                       cached_tail = 0;
+        alignas(cache_line_size) std::atomic<size_type> tail = {0};
+        size_type                                       cached_head = 0;
+        alignas(cache_line_size) slot_type              slots[MS];
+
+        void* address(size_type i) noexcept
+        {
+            return slots[i % MS].raw;
+        }
+
+        T& slot(size_type i) noexcept
+        {
+            return *std::launder(reinterpret_cast<T*>(slots[i % MS].raw));
+        }
+
+        //! Ensure the slot at counter t is free. (producer)
+        bool make_room(size_type t) noexcept
+        {
+            if (t - cached_head < MS)
+            {
+                return true;
+            }
+            cached_head = head.load(std::memory_order_acquire);
+            if (t - cached_head < MS)
+            {
+                return true;
+            }
+            if constexpr (Policy == overflow_policy::reject)
+            {
+                return false;
+            }
+            else
+            {
+                // drop the oldest element; if the consumer took it first,
+                // there is room anyway
+                auto h = cached_head;
+                if (head.compare_exchange_strong(h, h + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    h = h + 1;
+                }
+                cached_head = h;
+                return true;
+            }
+        }
+    };
+}
@@ -0,0 +1,232 @@
+// Rioki's Standard Extentions
+// Copyright 2020-2021 Sean Farrell <sean.farrell@rioki.org>
+//
+// This program is free software. It comes without any warranty, to
+// the extent permitted by applicable law. You can redistribute it
+// and/or modify it under the terms of the Do What The Fuck You Want
+// To Public License, Version 2, as published by Sam Hocevar.
+// See http://www.wtfpl.net/ for more details.
+
+#pragma once
+
+#include <cstddef>
+#include <chrono>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "iterator.h"
+
+namespace stdex
+{
+    //! Time Ring
+    //!
+    //! A ring that evicts elements by age instead of by count; it holds the
+    //! elements pushed within the last window of time, optionally capped to
+    //! a maximum number of elements.
+    //!
+    //! Expired elements are evicted lazily, in one batch, on push and on the
+    //! non const queries. For arithmetic types the sum of the live elements
+    //! is kept up to date, so count and sum are O(1) amortized. Since adding
+    //! and subtracting floating point values drifts, the sum is reset when
+    //! the ring runs empty and recomputed from the live elements once as
+    //! many elements were evicted as are left.
+    //!
+    //! Elements must be pushed in chronological order; an element stamped
+    //! earlier than the current back is stamped with the back's time.
+    template <typename T, typename Clock = std::chrono::steady_clock>
+    class time_ring
+    {
+    public:
+        using clock      = Clock;
+        using duration   = typename Clock::duration;
+        using time_point = typename Clock::time_point;
+
+        struct entry
+        {
+            time_point time;
+            T          value;
+        };
+
+        using container_type  = std::deque<entry>;
+        using value_type      = T;
+        using size_type       = typename container_type::size_type;
+        using const_reference = const value_type&;
+        using const_iterator  = typename container_type::const_iterator;
+
+        static constexpr size_type no_limit = std::numeric_limits<size_type>::max();
+
+        //! Create a time ring.
+        //!
+        //! @param window_size how long elements stay in the ring
+        //! @param max_size hard cap on the number of elements
+        //! @throw std::invalid_argument if max_size is zero
+        explicit time_ring(duration window_size, size_type max_size = no_limit)
+        : window(window_size), limit(max_size)
+        {
+            if (max_size == 0)
+            {
+                throw std::invalid_argument("time_ring: max_size must not be zero");
+            }
+        }
+
+        duration window_size() const noexcept
+        {
+            return window;
+        }
+
+        size_type max_size() const noexcept
+        {
+            return limit;
+        }
+
+        const_reference front() const noexcept
+        {
+            return entries.front().value;
+        }
+
+        const_reference back() const noexcept
+        {
+            return entries.back().value;
+        }
+
+        //! The live entries with their time stamps, oldest first.
+        //!
+        //! Call expire first to drop the expired entries.
+        const_iterator begin() const noexcept
+        {
+            return entries.begin();
+        }
+
+        const_iterator end() const noexcept
+        {
+            return entries.end();
+        }
+
+        //! Number of elements, including the ones not yet expired lazily.
+        size_type size() const noexcept
+        {
+            return entries.size();
+        }
+
+        bool empty() const noexcept
+        {
+            return entries.empty();
+        }
+
+        //! Number of elements within the window at now.
+        size_type count(time_point now = Clock::now())
+        {
+            expire(now);
+            return entries.size();
+        }
+
+        //! Sum of the elements within the window at now.
+        T sum(time_point now = Clock::now())
+        {
+            static_assert(std::is_arithmetic_v<T>, "sum requires an arithmetic type");
+            expire(now);
+            return total;
+        }
+
+        void push_back(const T& value, time_point now = Clock::now())
+        {
+            emplace_at(now, value);
+        }
+
+        void push_back(T&& value, time_point now = Clock::now())
+        {
+            emplace_at(now, std::move(value));
+        }
+
+        //! Construct an element in place, stamped with time.
+        template <typename... Args>
+        void emplace_at(time_point time, Args&&... args)
+        {
+            if (!entries.empty() && time < entries.back().time)
+            {
+                time = entries.back().time;
+            }
+            expire(time);
+            if (entries.size() >= limit)
+            {
+                evict(entries.size() - limit + 1);
+            }
+
+            entries.push_back(entry{time, T(std::forward<Args>(args)...)});
+            if constexpr (std::is_arithmetic_v<T>)
+            {
+                total += entries.back().value;
+            }
+        }
+
+        //! Evict all elements older than the window at now.
+        void expire(time_point now = Clock::now())
+        {
+            auto n = size_type(0);
+            for (auto i = entries.begin(); i != entries.end() && now - i->time >= window; ++i)
+            {
+                n++;
+            }
+            evict(n);
+        }
+
+        void pop_front()
+        {
+            evict(1);
+        }
+
+        void clear() noexcept
+        {
+            entries.clear();
+            total   = T();
+            evicted = 0;
+        }
+
+    private:
+        container_type entries;
+        duration       window;
+        size_type      limit;
+        T              total   = T();
+        // evicted since the sum was last recomputed
+        size_type      evicted = 0;
+
+        void evict(size_type n)
+        {
+            if (n == 0)
+            {
+                return;
+            }
+            auto erase_end = inline_advance(entries.begin(), n);
+            if constexpr (std::is_arithmetic_v<T>)
+            {
+                for (auto i = entries.begin(); i != erase_end; ++i)
+                {
+                    total -= i->value;
+                }
+            }
+            entries.erase(entries.begin(), erase_end);
+
+            if constexpr (std::is_arithmetic_v<T>)
+            {
+                evicted += n;
+                if (entries.empty())
+                {
+                    total   = T();
+                    evicted = 0;
+                }
+                else if (std::is_floating_point_v<T> && evicted >= entries.size())
+                {
+                    total = T();
+                    for (const auto& e : entries)
+                    {
+                        total += e.value;
+                    }
+                    evicted = 0;
+                }
+            }
+        }
+    };
+}